@@ -48,6 +48,8 @@ public Textarea info;
 
 Executioner execute;
 Thread executeThread;
+PortScanner portScanner;
+Thread portScannerThread;
 ClipHelper cp;
 
 PImage astroEQLogo;
@@ -183,6 +185,12 @@ void setup() {
   execute   = (Executioner) new NullInterface(this); //using NullInterface as it is an empty implementation of Executioner and we don't need a specialised type yet.
   executeThread = new Thread(execute);
   
+  println("Creating Port Scanner thread");
+  portScanner = new PortScanner(); //Serial ports are enumerated in the background so that slow ports don't freeze the GUI
+  portScannerThread = new Thread(portScanner);
+  portScannerThread.setDaemon(true);
+  portScannerThread.start();
+  
   println("Connecting to Clipboard");
   
   try {
@@ -255,7 +263,7 @@ void setup() {
            .updateSize();
   version = controlP5.addScrollableList("version",configDim.centre()+5,configDim.top()+2,configDim.centre()-52,120);
   versionListDrop(version, versions);
-  refreshComm();
+  portListSetup(port); //Ports are added once the port scanner has found them.
   port.setMoveable(false);
   version.setMoveable(false); 
   
@@ -264,11 +272,18 @@ void setup() {
 }
 
 void refreshComm() {
-  println("Initialising Serial Ports");
-  String[] comports = Serial.list();
-  println((Object[])comports);
-  portListDrop(port, comports);
-  curPort = null;
+  println("Refreshing Serial Ports");
+  portScanner.rescan(); //The list will be updated from draw() once the scan completes.
+}
+
+void updateComm() {
+  if (portScanner.hasChanged() && !execute.status().isRunning()) {
+    //Only update the list while no task is running, as the task may have the port open.
+    String[] comports = portScanner.getPorts();
+    println("Serial Ports:");
+    println((Object[])comports);
+    portListDrop(port, comports);
+  }
 }
 
 void draw() {
@@ -292,6 +307,7 @@ void draw() {
   noStroke();
   rect(headerDim.left(),headerDim.mapToGlobalY(LOGO_HEIGHT),headerDim.width(),TEXTBAR_HEIGHT);
   stroke(#000000);
+  updateComm();
   ui.updateDisplay(execute.status());
   port.show();
   version.show();
@@ -410,26 +426,46 @@ void versionListDrop(ScrollableList ddl, String[] files) {
 }
 
 
-void portListDrop(ScrollableList ddl, String[] files) {
+void portListSetup(ScrollableList ddl) {
   ddl.setBackgroundColor(color(190));
   ddl.setItemHeight(TEXTBAR_HEIGHT);
   ddl.setBarHeight(ELEMENT_HEIGHT);
   ddl.getCaptionLabel().set("Select COM Port");
   ddl.getCaptionLabel().getStyle().marginLeft = 3;
 
-  int litem = 0;
   ddl.clear();
-  for (int i = 0; i < files.length; i++) {
-    
-    ddl.addItem(files[i], litem);
-    litem++;
-  }
 
   ddl.close();
   ddl.setColorBackground(color(60));
   ddl.setColorActive(color(255,128));
 }
 
+void portListDrop(ScrollableList ddl, String[] files) {
+  //Only add and remove the ports which have changed so that the current selection is kept.
+  List<String> newPorts = Arrays.asList(files);
+  List<String> oldPorts = new ArrayList<String>();
+  for (Map<String,Object> item : ddl.getItems()) {
+    oldPorts.add((String)item.get("name"));
+  }
+  for (String oldPort : oldPorts) {
+    if (!newPorts.contains(oldPort)) {
+      ddl.removeItem(oldPort);
+    }
+  }
+  for (String newPort : newPorts) {
+    if (!oldPorts.contains(newPort)) {
+      ddl.addItem(newPort, newPort);
+    }
+  }
+  
+  if ((curPort != null) && !newPorts.contains(curPort)) {
+    //The selected port has been unplugged.
+    println("COM Port " + curPort + " removed");
+    curPort = null;
+    ddl.getCaptionLabel().set("Select COM Port");
+  }
+}
+
 private static boolean shiftDown = false;
 private static boolean ctrlDown = false;
 private static String clipboard = "";
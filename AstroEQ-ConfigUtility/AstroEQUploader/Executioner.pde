@@ -239,6 +239,48 @@ public class EEPROMInterface extends Executioner {
       println("Failed to recieve response.");
     }
     
+    List<String> afterStore = null;
+    int[] expectedChecksum = null;
+    if ((exitCode == 0) && mode.equals("2") && args.contains(":T1")) {
+      //When storing, only send what has actually changed.
+      List<String> changes = diffConfiguration(args);
+      if (changes != null) {
+        expectedChecksum = diffChecksum;
+        int storeIndex = args.indexOf(":T1");
+        afterStore = new ArrayList<String>(args.subList(storeIndex+1, args.size()));
+        args = changes;
+        args.add(":T1");
+      }
+    }
+    
+    exitCode = sendCommands(args, mode, exitCode);
+    
+    if ((exitCode == 0) && (expectedChecksum != null)) {
+      //Confirm that what was stored is exactly the requested configuration.
+      for (int axis = 0; axis < 2; axis++) {
+        String checksum = query(":v"+(axis+1));
+        if (checksum == null) {
+          exitCode = 2; //no response, communication lost.
+          break;
+        } else if (decodeValue(checksum) != expectedChecksum[axis]) {
+          println("Verification failed on axis "+(axis+1));
+          buffer.add("Verification Failed!");
+          exitCode = 5; //stored config doesn't match.
+          break;
+        }
+      }
+      if (exitCode == 0) {
+        exitCode = sendCommands(afterStore, mode, exitCode);
+      }
+    }
+        
+    execStatus.setStatus(false,true,exitCode);
+    return;
+  
+  }
+  
+  private int sendCommands(List<String> args, String mode, int exitCode) {
+    String readback;
     while ((args.size() > 0) && (exitCode == 0)) {
       String arg = args.get(0);
       args.remove(0);
@@ -282,10 +324,171 @@ public class EEPROMInterface extends Executioner {
         break;
       }
     }
-        
-    execStatus.setStatus(false,true,exitCode);
-    return;
+    return exitCode;
+  }
+  
+  //Sends a command and returns the data from its response, or null if there was an error or no response.
+  private String query(String command) {
+    println(command);
+    write(command+"\r");
+    String readback = getResponse(20000,'\r');
+    println(readback);
+    if ((readback == null) || !readback.startsWith("=")) {
+      return null;
+    }
+    return readback.substring(1,readback.length()-1);
+  }
+  
+  //Decodes the data of a command or response. Longs are 6 characters, bytes 2, and :C takes a single digit.
+  private long decodeValue(String data) {
+    if (data.length() == 6) {
+      return Long.parseLong(SyntaString.syntaEncoder(data,SyntaString.argIsLong,SyntaString.decode));
+    } else if (data.length() == 2) {
+      return Long.parseLong(SyntaString.syntaEncoder(data,SyntaString.argIsByte,SyntaString.decode));
+    }
+    return Long.parseLong(data);
+  }
+  
+  //The settings covered by the :v checksum, in the order the firmware adds them. Entries are {key, size in bytes, is boolean}.
+  //The sizes are those of the types the firmware holds the settings in when built with avr-gcc (long = 4, int = 2, bool = 1,
+  //and normalGotoSpeed is an int even though only one byte is stored), so they must be updated if those types ever change.
+  private final String[][] checksumFields = {
+    {"A","4","0"}, {"B","4","0"}, {"S","4","0"}, {"N","2","0"}, {"Z","2","0"}, {"C","1","1"},
+    {"D1","1","0"}, {"D2","1","0"}, {"Q2","1","1"}, {"Q1","1","1"}, {"R1","1","0"}, {"R2","2","0"}
+  };
+  
+  private int crcUpdate(int crc, long value, int bytes) {
+    //CRC-16/CCITT, the same as _crc_ccitt_update() in avr-libc
+    for (int i = 0; i < bytes; i++) {
+      crc ^= (int)(value >>> (8*i)) & 0xFF;
+      for (int j = 0; j < 8; j++) {
+        crc = ((crc & 1) != 0) ? ((crc >>> 1) ^ 0x8408) : (crc >>> 1);
+      }
+    }
+    return crc;
+  }
   
+  private int configChecksum(int axis, Map<String, Long> settings, long[] accelTable) {
+    int crc = 0xFFFF;
+    for (String[] field : checksumFields) {
+      String key = (field[0].length() == 1) ? field[0]+(axis+1) : field[0];
+      long value = settings.get(key);
+      if (field[2].equals("1")) {
+        value = (value != 0) ? 1 : 0; //stored as a bool
+      }
+      crc = crcUpdate(crc, value, Integer.parseInt(field[1]));
+    }
+    for (long entry : accelTable) {
+      crc = crcUpdate(crc, entry & 0xFFFF, 2); //speed
+      crc = crcUpdate(crc, (entry >>> 16) & 0xFF, 1); //repeats
+    }
+    return crc;
+  }
+  
+  private int[] diffChecksum;
+  
+  //Reads the current configuration and returns only the commands from the list which would change it (excluding :T1 and anything
+  //after it). Sets diffChecksum to the checksums expected once stored. Returns null if the full list should be sent instead, for
+  //example if the firmware is too old to support the :v command.
+  private List<String> diffConfiguration(List<String> args) {
+    final int ACCEL_TABLE_LEN = 64;
+    Map<String, String> requested = new LinkedHashMap<String, String>();
+    long[][] requestedTable = new long[2][ACCEL_TABLE_LEN];
+    boolean[][] tableRequested = new boolean[2][ACCEL_TABLE_LEN];
+    int[] tableIndex = {0,0};
+    //Work out what the command list would set.
+    for (String arg : args) {
+      if (arg.equals(":T1")) {
+        break;
+      }
+      if ((arg.length() < 4) || (arg.charAt(0) != ':')) {
+        continue;
+      }
+      String key = arg.substring(1,3);
+      int axis = (arg.charAt(2) == '1') ? 0 : 1;
+      String data = arg.substring(3);
+      if (key.charAt(0) == 'Y') {
+        tableIndex[axis] = (int)decodeValue(data);
+      } else if (key.charAt(0) == 'X') {
+        requestedTable[axis][tableIndex[axis]] = decodeValue(data);
+        tableRequested[axis][tableIndex[axis]] = true;
+        tableIndex[axis] = (tableIndex[axis] + 1) % ACCEL_TABLE_LEN;
+      } else {
+        requested.put(key, data);
+      }
+    }
+    
+    //Read the current settings.
+    Map<String, Long> current = new HashMap<String, Long>();
+    Map<String, Long> updated = new HashMap<String, Long>();
+    for (String[] field : checksumFields) {
+      for (int axis = 0; axis < ((field[0].length() == 1) ? 2 : 1); axis++) {
+        String key = (field[0].length() == 1) ? field[0]+(axis+1) : field[0];
+        String value = query(":"+key.toLowerCase());
+        if (value == null) {
+          return null;
+        }
+        current.put(key, decodeValue(value));
+        updated.put(key, requested.containsKey(key) ? decodeValue(requested.get(key)) : decodeValue(value));
+      }
+    }
+    
+    List<String> changes = new ArrayList<String>();
+    for (Map.Entry<String, String> entry : requested.entrySet()) {
+      String key = entry.getKey();
+      if (!current.containsKey(key) || (current.get(key).longValue() != updated.get(key).longValue())) {
+        changes.add(":"+key+entry.getValue());
+      }
+    }
+    
+    diffChecksum = new int[2];
+    for (int axis = 0; axis < 2; axis++) {
+      String checksum = query(":v"+(axis+1));
+      if (checksum == null) {
+        return null; //Firmware doesn't support checksums.
+      }
+      long[] currentTable = new long[ACCEL_TABLE_LEN];
+      long[] updatedTable = new long[ACCEL_TABLE_LEN];
+      boolean tableUnchanged;
+      //The checksum covers the stored settings and table. These are what the board loaded when it was reset on connecting, so if it
+      //matches the current settings with the requested table then the table is unchanged.
+      if (configChecksum(axis, current, requestedTable[axis]) == decodeValue(checksum)) {
+        updatedTable = requestedTable[axis];
+        tableUnchanged = true;
+      } else {
+        //Otherwise read back the table to find which entries have changed.
+        if (query(":Y"+(axis+1)+SyntaString.syntaEncoder("0",SyntaString.argIsByte,SyntaString.encode)) == null) {
+          return null;
+        }
+        for (int i = 0; i < ACCEL_TABLE_LEN; i++) {
+          String value = query(":x"+(axis+1));
+          if (value == null) {
+            return null;
+          }
+          currentTable[i] = decodeValue(value);
+          updatedTable[i] = tableRequested[axis][i] ? requestedTable[axis][i] : currentTable[i];
+        }
+        tableUnchanged = false;
+      }
+      if (!tableUnchanged) {
+        //Send only the changed entries. The index auto-increments, so :Y is only needed at the start of each run of changes.
+        int nextIndex = -1;
+        for (int i = 0; i < ACCEL_TABLE_LEN; i++) {
+          if (currentTable[i] == updatedTable[i]) {
+            continue;
+          }
+          if (i != nextIndex) {
+            changes.add(":Y"+(axis+1)+SyntaString.syntaEncoder(""+i,SyntaString.argIsByte,SyntaString.encode));
+          }
+          changes.add(":X"+(axis+1)+SyntaString.syntaEncoder(""+updatedTable[i],SyntaString.argIsLong,SyntaString.encode));
+          nextIndex = i + 1;
+        }
+      }
+      diffChecksum[axis] = configChecksum(axis, updated, updatedTable);
+    }
+    println("Sending "+changes.size()+" changed settings.");
+    buffer.add("Sending "+changes.size()+" changed settings.");
+    return changes;
   }
   
   private String getResponse(int timeout, int marker){
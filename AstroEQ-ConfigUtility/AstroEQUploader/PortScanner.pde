@@ -0,0 +1,79 @@
+import processing.serial.*;
+import java.util.Arrays;
+
+//Enumerates the serial ports on a background thread. Serial.list() can block for several seconds on
+//systems with many Bluetooth or virtual ports, so it must never be called from the UI thread. The
+//latest list is cached, and the port list is polled periodically so that hotplugged boards appear.
+//Scanning is paused while a task is running, as the task may have the port open (e.g. avrdude during
+//the bootloader reset, or a configuration session) and enumerating the ports could interfere with it.
+public class PortScanner implements Runnable {
+
+  private final static int SCAN_INTERVAL = 2000; //ms between polls for hotplug
+  private final static int TASK_POLL_INTERVAL = 250; //ms between checks for the running task finishing
+
+  private String[] ports = new String[0];
+  private boolean changed = false;
+  private boolean rescan = false;
+
+  //Request an immediate rescan rather than waiting for the next poll
+  public synchronized void rescan() {
+    rescan = true;
+    notifyAll();
+  }
+
+  //Returns true if the port list has changed since it was last fetched
+  public synchronized boolean hasChanged() {
+    return changed;
+  }
+
+  //Returns the cached port list
+  public synchronized String[] getPorts() {
+    changed = false;
+    return ports;
+  }
+
+  private synchronized void setPorts(String[] newPorts) {
+    if (!Arrays.equals(ports, newPorts)) {
+      ports = newPorts;
+      changed = true;
+    }
+  }
+
+  private synchronized void waitForNextScan() throws InterruptedException {
+    if (!rescan) {
+      wait(SCAN_INTERVAL);
+    }
+    rescan = false;
+  }
+
+  //Waits a short while without clearing any rescan request, so that it is serviced once the task finishes
+  private synchronized void waitForTask() throws InterruptedException {
+    wait(TASK_POLL_INTERVAL);
+  }
+
+  private boolean taskRunning() {
+    Executioner task = execute; //The sketch replaces the executioner for each new task.
+    return (task != null) && task.status().isRunning();
+  }
+
+  public void run() {
+    try {
+      while (!Thread.currentThread().isInterrupted()) {
+        if (taskRunning()) {
+          waitForTask();
+          continue;
+        }
+        String[] newPorts;
+        try {
+          newPorts = Serial.list();
+        } catch (Exception e) {
+          newPorts = new String[0];
+        }
+        setPorts(newPorts);
+        waitForNextScan();
+      }
+    } catch (InterruptedException e) {
+      //Exit quietly.
+    }
+  }
+}
@@ -1846,7 +1846,11 @@ class UploaderGUI {
             next.setCaptionLabel("Back");
           }
           if (message != null) {
-            message.setValue("Write Failed!! Connection unavailable.");
+            if (execStatus.errorCode() == 5) {
+              message.setValue("Write Failed!! Stored configuration did not verify.");
+            } else {
+              message.setValue("Write Failed!! Connection unavailable.");
+            }
           }
           closeSerialPort();
           screenStatus = 1;
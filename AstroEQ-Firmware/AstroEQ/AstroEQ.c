@@ -26,9 +26,13 @@
 #include "SerialLink.h" //Serial Port
 #include "UnionHelpers.h" //Union prototypes
 #include "synta.h" //Synta Communications Protocol.
+#ifdef MOUNT_PRESETS
+#include "MountPresets.h" //Built-in mount configurations (generated)
+#endif
 #include <util/delay.h>    
 #include <util/delay_basic.h>
 #include <avr/wdt.h>
+#include <util/crc16.h>
 
 // Watchdog disable on boot.
 void wdt_init(void) __attribute__((naked)) __attribute__((section(".init3")));
@@ -63,9 +67,35 @@ bool canJumpToHighspeed = false;
 bool defaultSpeedState = SPEEDNORM;
 bool disableGearChange = false;
 bool allowAdvancedHCDetection = false;
-unsigned int gotoDecelerationLength[2];
-byte accelTableRepeatsLeft[2] = {0,0};
+#ifdef PERSIST_GUIDE_RATE
+bool guideRateChanged = false; //Set when the :P command changes the guide rate, cleared once the new rate has been saved.
+#endif
+unsigned int gotoSpeedOverride[2] = {0,0}; //Maximum speed for the next goto only. 0 = use normalGotoSpeed. Set by :W
+byte gotoRampScaleOverride[2] = {0,0}; //Acceleration ramp scale for the next goto only. 0 = use the table profile. Set by :W
+byte accelRampScale[2] = {16,16}; //Scale applied to the acceleration table durations in 1/16ths. 16 = use the table profile as is.
+unsigned long gotoBrakeLength[2] = {0UL,0UL}; //Host requested deceleration start offset for the next goto only (:M command). 0 = use the deceleration ramp length.
+unsigned long gotoLandingPosn[2] = {0UL,0UL}; //Position at which the final step of a goto is started
+unsigned int gotoBrakeSpeed[2]; //Speed to decelerate to at the brake point. Either the stop speed (crawl to landing), or slower (stop at end of ramp).
+bool ditherActive[2] = {false,false}; //true whilst a dither move is in progress on the axis
+unsigned long ditherEndPosn[2] = {0UL,0UL}; //RA position at which a dither is complete and tracking resumes
+unsigned int ditherTrackingIVal; //Tracking speed for RA to return to at the end of a dither
+bool ditherSettled = true; //Whether both axes have been steady for the settle time since the last dither
+unsigned long ditherSettleStart = 0; //System tick at which the axes were last seen moving
+unsigned int ditherSettleTime = 1000; //Time in ms that the axes must be steady after a dither to be considered settled. Set by :W
+unsigned int approachOvershoot[2] = {0,0}; //Number of steps to overshoot a goto by so the target can be approached from the preferred direction. 0 = disabled. Set by :W
+bool approachDir[2] = {CMD_FORWARD,CMD_FORWARD}; //Preferred direction to finish a goto in. For RA this follows the tracking direction.
+bool approachPending[2] = {false,false}; //true if a goto has overshot and still needs to return to the target
+unsigned long approachTarget[2] = {0UL,0UL}; //Target position of the current goto
+long accelTableTicksLeft[2] = {0,0}; //Time left at the current accel table entry. Goes negative if a step overran the entry.
 byte accelTableIndex[2] = {0,0};
+#if defined(__AVR_ATmega162__)
+//The ATMega162 has no GPIOR registers, so the interrupt state they hold on the Mega is kept in fixed SRAM instead. This
+//is a cycle slower to access than a register, but unlike reserved registers it can't be clobbered by library code.
+volatile byte gotoControlRegisterRA = 0; //Each axis has its own goto control byte so that the nested step interrupts
+volatile byte gotoControlRegisterDC = 0; //never read-modify-write a shared byte.
+volatile byte distributionSegmentRA = 0;
+volatile byte distributionSegmentDC = 0;
+#endif
 
 /*
  * Helper Macros
@@ -82,18 +112,32 @@ byte accelTableIndex[2] = {0,0};
 //Registers
 //For setting an RA/DC register -> macro(RA,setValue)
 //For getting an RA/DC register -> macro(DC)
+#if defined(__AVR_ATmega162__)
+#define distributionSegment(...)      GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(distributionSegmentDC,distributionSegmentRA,__VA_ARGS__)
+#else
 #define distributionSegment(...)      GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(GPIOR1,GPIOR2,__VA_ARGS__)
+#endif
 #define currentMotorSpeed(...)        GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )( OCR3A, OCR3B,__VA_ARGS__)
 #define irqToNextStep(...)            GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )( OCR1A, OCR1B,__VA_ARGS__)
 #define timerCountRegister(...)       GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )( TCNT3, TCNT1,__VA_ARGS__)
 #define timerPrescalarRegister(...)   GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(TCCR3B,TCCR1B,__VA_ARGS__)
 #define interruptOVFCount(...)        GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(  ICR3,  ICR1,__VA_ARGS__)
 #define interruptControlRegister(...) GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(TIMSK3,TIMSK1,__VA_ARGS__)
-#define gotoControlRegister GPIOR0
+#if defined(__AVR_ATmega162__)
+#define gotoControlRegister(...)      GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(gotoControlRegisterDC,gotoControlRegisterRA,__VA_ARGS__)
+#else
+#define gotoControlRegister(...)      GET_TERNARY_MACRO(__VA_ARGS__, SET_TERNARY_REGISTER , GET_TERNARY_REGISTER )(GPIOR0,GPIOR0,__VA_ARGS__)
+#endif
 //Bit Masks
 #define interruptControlBitMask(m)  (m ? _BV(ICIE3) : _BV(ICIE1))
+#if defined(__AVR_ATmega162__)
+//Each axis has its own goto control register, so the bits are the same for both.
+#define gotoDeceleratingBitMask(m)  (m ? _BV(    1) : _BV(    1))
+#define gotoRunningBitMask(m)       (m ? _BV(    0) : _BV(    0))
+#else
 #define gotoDeceleratingBitMask(m)  (m ? _BV(    3) : _BV(    2))
 #define gotoRunningBitMask(m)       (m ? _BV(    1) : _BV(    0))
+#endif
 
 
 
@@ -103,22 +147,34 @@ byte accelTableIndex[2] = {0,0};
  * Inline functions
  */
 inline bool gotoRunning(const byte axis) {
-    return (gotoControlRegister & gotoRunningBitMask(axis));
+    return (gotoControlRegister(axis) & gotoRunningBitMask(axis));
 }
 inline bool gotoDecelerating(const byte axis) {
-    return (gotoControlRegister & gotoDeceleratingBitMask(axis));
+    return (gotoControlRegister(axis) & gotoDeceleratingBitMask(axis));
 }
 inline void setGotoRunning(const byte axis) {
-    gotoControlRegister |= gotoRunningBitMask(axis);
+    gotoControlRegister(axis, gotoControlRegister(axis) | gotoRunningBitMask(axis));
 }
 inline void clearGotoRunning(const byte axis) {
-    gotoControlRegister &= ~gotoRunningBitMask(axis);
+    gotoControlRegister(axis, gotoControlRegister(axis) & ~gotoRunningBitMask(axis));
 }
 inline void setGotoDecelerating(const byte axis) {
-    gotoControlRegister |= gotoDeceleratingBitMask(axis);
+    gotoControlRegister(axis, gotoControlRegister(axis) | gotoDeceleratingBitMask(axis));
 }
 inline void clearGotoDecelerating(const byte axis) {
-    gotoControlRegister &= ~gotoDeceleratingBitMask(axis);
+    gotoControlRegister(axis, gotoControlRegister(axis) & ~gotoDeceleratingBitMask(axis));
+}
+inline unsigned int accelTableGear(const byte axis) {
+    //The table is specified in normal-speed steps. In high-speed mode each step is gVal times larger, so each speed in the
+    //table is gVal times faster, and each entry must last gVal times longer to give the same physical acceleration.
+    return cmd.highSpeedMode[axis] ? cmd.gVal[axis] : 1;
+}
+inline unsigned long accelTableTicks(const byte axis, const byte index) {
+    //Time to spend at this entry in timer ticks (step periods are 2*speed interrupts, so ticks here are counted in pairs). The
+    //table gives 1 step + number of repeats at this speed in normal-speed mode. This is scaled for the gear and ramp scale.
+    unsigned long ticks = (unsigned long)(cmd.accelTable[axis][index].repeats + 1) * cmd.accelTable[axis][index].speed;
+    ticks = ticks * accelTableGear(axis);
+    return (ticks * accelRampScale[axis]) >> 4; //Then scale the ramp for the current move.
 }
 
 
@@ -168,26 +224,181 @@ void buildModeMapping(byte microsteps, byte driverVersion){
 
 
 
+/*
+ * System Tick
+ */
+
+//Timer 0 provides a 1ms timebase which is independent of the motor timers.
+#define SYSTEM_TICK_PRESCALE 64
+#define SYSTEM_TICK_RATE 1000 //Hz
+volatile unsigned long systemTickCount = 0;
+
+void configureSystemTick() {
+    //Set to CTC mode with a /64 prescaler, and interrupt on compare match.
+#if defined(__AVR_ATmega162__)
+    TCCR0 = _BV(WGM01) | _BV(CS01) | _BV(CS00);
+    OCR0 = (F_CPU / SYSTEM_TICK_PRESCALE / SYSTEM_TICK_RATE) - 1;
+    TCNT0 = 0;
+    TIMSK |= _BV(OCIE0);
+#else
+    TCCR0A = _BV(WGM01);
+    TCCR0B = _BV(CS01) | _BV(CS00);
+    OCR0A = (F_CPU / SYSTEM_TICK_PRESCALE / SYSTEM_TICK_RATE) - 1;
+    TCNT0 = 0;
+    TIMSK0 = _BV(OCIE0A);
+#endif
+}
+
+unsigned long systemTicks() {
+    byte oldSREG = SREG;
+    cli(); //The tick count is 4 bytes, so read it atomically.
+    unsigned long ticks = systemTickCount;
+    SREG = oldSREG;
+    return ticks;
+}
+
+/*Timer Interrupt Vector*/
+ISR(TIMER0_COMPA_vect, ISR_NOBLOCK) {
+    //Let the step timers interrupt us, the tick count can wait a few cycles.
+    systemTickCount++;
+}
+
+
+
+
+/*
+ * Tracking Supervisor
+ */
+
+//The step rate is built from integer timer periods, so any rounding in timerOVF would integrate forever. The supervisor measures
+//how far the axis has moved in timer interrupts, and compares it with the ideal number of interrupts (2 x bVal per second) for
+//the elapsed system ticks. The step timing is then nudged to keep the error to a fraction of a step.
+//The arithmetic is done as exact quotient and remainder in 32bit rather than 64bit, as the 64bit library routines are large
+//and slow on the AVR.
+#define TRACKING_PERIOD 100 //ms between checks
+unsigned long trackingTicks[2]; //System tick at the last check
+unsigned long trackingPosn[2]; //jVal at the last check
+long trackingPhase[2]; //Number of interrupts into the current step at the last check
+unsigned int trackingIVal[2] = {0,0}; //Speed being supervised. 0 = not currently supervising.
+unsigned int trackingIdealRem[2]; //Fractional part of the ideal position in 1/500ths of an interrupt
+long trackingError[2]; //Ideal minus actual position in interrupts
+
+void trackingSupervisor(byte axis){
+    unsigned long ticks = systemTicks();
+    unsigned long elapsed = ticks - trackingTicks[axis];
+    if (elapsed < TRACKING_PERIOD) {
+        return; //Not time to check yet. When not supervising, this also limits how often we look for a steady speed.
+    }
+    if (cmd.stopped[axis] != CMD_RUNNING) {
+        //Nothing to supervise while stopped, so there is no need to take a snapshot.
+        trackingIVal[axis] = 0;
+        trackingTicks[axis] = ticks;
+        return;
+    }
+    
+    //Take a snapshot of the position, including how far through the current step we are.
+    byte oldSREG = SREG;
+    cli(); //The next bit needs to be atomic as the motor may be running
+    unsigned long jVal = cmd.jVal[axis];
+    unsigned int speed = currentMotorSpeed(axis);
+    long phase = (long)speed - (long)irqToNextStep(axis);
+    if (getPinValue(stepPin[axis])) {
+        phase = phase + speed; //In the second half of the step.
+    }
+    SREG = oldSREG;
+    
+    unsigned int IVal = cmd.currentIVal[axis];
+    bool steady = (cmd.stopped[axis] == CMD_RUNNING) && !gotoRunning(axis) && (abs(cmd.stepDir[axis]) == 1) && (speed == IVal);
+    if (!steady || (IVal != trackingIVal[axis]) || (elapsed > 1000)) {
+        //If we aren't running steadily, or the speed has changed, start again from here.
+        trackingIVal[axis] = steady ? IVal : 0;
+        trackingTicks[axis] = ticks;
+        trackingPosn[axis] = jVal;
+        trackingPhase[axis] = phase;
+        trackingIdealRem[axis] = 0;
+        trackingError[axis] = 0;
+        return;
+    }
+    
+    //Ideal number of interrupts in the elapsed time is elapsed * 2 * bVal / 1000.
+    unsigned long bVal = cmd.bVal[axis];
+    unsigned long idealRem = trackingIdealRem[axis] + elapsed * (bVal % 500);
+    long ideal = elapsed * (bVal / 500) + (idealRem / 500);
+    trackingIdealRem[axis] = idealRem % 500;
+    
+    //Actual number of interrupts moved is 2 x speed per step plus the change in phase.
+    long steps = jVal - trackingPosn[axis];
+    if (cmd.stepDir[axis] < 0) {
+        steps = -steps;
+    }
+    long actual = steps * 2 * speed + (phase - trackingPhase[axis]);
+    
+    trackingTicks[axis] = ticks;
+    trackingPosn[axis] = jVal;
+    trackingPhase[axis] = phase;
+    
+    long error = trackingError[axis] + ideal - actual;
+    unsigned long errorMagnitude = labs(error);
+    if (errorMagnitude >= (4UL * speed)) {
+        //More than two steps out means something other than rounding has moved the axis, so start again from here.
+        error = 0;
+    } else if (errorMagnitude > (speed >> 2)) {
+        //If we are more than 1/8th of a step out, adjust the time to the next step edge by up to a quarter step.
+        unsigned int nudge = (errorMagnitude > (speed >> 1)) ? (speed >> 1) : errorMagnitude;
+        oldSREG = SREG;
+        cli(); //The next bit needs to be atomic as the motor is running
+        unsigned int irqToNext = irqToNextStep(axis);
+        if (error > 0) {
+            //Behind the ideal position, so take the next step sooner.
+            if (nudge >= irqToNext) {
+                nudge = irqToNext - 1;
+            }
+            irqToNextStep(axis, irqToNext - nudge);
+        } else {
+            //Ahead of the ideal position, so take the next step later.
+            if (nudge > (0xFFFF - irqToNext)) {
+                nudge = 0xFFFF - irqToNext; //Don't let the count wrap at very slow speeds, which would make the step early.
+            }
+            irqToNextStep(axis, irqToNext + nudge);
+        }
+        SREG = oldSREG;
+        //The nudge will be seen as a change in phase at the next check, so the error is not adjusted here.
+    }
+    trackingError[axis] = error;
+}
+
+
+
+
 /*
  * System Initialisation Routines
  */
 
-void calculateDecelerationLength (byte axis){
+unsigned long calculateDecelerationLength (byte axis, unsigned int gotoSpeed){
 
-    unsigned int gotoSpeed = cmd.normalGotoSpeed[axis];
     byte lookupTableIndex = 0;
-    unsigned int numberOfSteps = 0;
-    //Work through the acceleration table until we get to the right speed (accel and decel are same number of steps)
-    while(lookupTableIndex < AccelTableLength) {
-        if (cmd.accelTable[axis][lookupTableIndex].speed <= gotoSpeed) {
-            //If we have reached the element at which we are now at the right speed
-            break; //We have calculated the number of accel steps and therefore number of decel steps.
-        }
-        numberOfSteps = numberOfSteps + cmd.accelTable[axis][lookupTableIndex].repeats + 1; //Add on the number of steps at this speed (1 step + number of repeats)
+    //Find the entry at which acceleration stops once we are at the goto speed (accel and decel use the same entries).
+    while((lookupTableIndex < AccelTableLength-1) && (cmd.accelTable[axis][lookupTableIndex].speed > gotoSpeed)) {
         lookupTableIndex++;
     }
+    //Then follow the deceleration the step ISR will perform. The ISR moves down one entry at the start of the first step after
+    //the time at the current entry has run out, and carries any overrun into the next entry. So each entry takes the number of
+    //step periods needed to use up its time plus the carried overrun (at least one step), and the new overrun is carried on.
+    unsigned long numberOfSteps = 0;
+    long ticksLeft = -(long)gotoSpeed; //Deceleration starts with no time left, and the first step counts down the last cruise step.
+    while(lookupTableIndex > 0) {
+        lookupTableIndex--;
+        unsigned int speed = cmd.accelTable[axis][lookupTableIndex].speed;
+        ticksLeft = ticksLeft + accelTableTicks(axis, lookupTableIndex);
+        unsigned long steps = 1;
+        if (ticksLeft > (long)speed) {
+            steps = ((unsigned long)ticksLeft + speed - 1) / speed; //Steps until the time left is used up (rounded up).
+        }
+        numberOfSteps = numberOfSteps + steps;
+        ticksLeft = ticksLeft - (long)(steps * speed); //Whatever is left (<= 0) is the overrun carried into the next entry.
+    }
     //number of steps now contains how many steps required to slow to a stop.
-    gotoDecelerationLength[axis] = numberOfSteps;
+    return numberOfSteps;
 }
 
 void calculateRate(byte axis){
@@ -263,8 +474,6 @@ void systemInitialiser(){
 
     calculateRate(RA); //Initialise the interrupt speed table. This now only has to be done once at the beginning.
     calculateRate(DC); //Initialise the interrupt speed table. This now only has to be done once at the beginning.
-    calculateDecelerationLength(RA);
-    calculateDecelerationLength(DC);
     
     //Status pin to output low
     setPinDir  (statusPin,OUTPUT);
@@ -335,16 +544,8 @@ void systemInitialiser(){
     setPinValue(resetPin[RA],HIGH);
     setPinValue(resetPin[DC],HIGH);
     
-#if defined(__AVR_ATmega162__)
-    //Disable Timer 0
-    //Timer 0 registers are being used as general purpose data storage for high efficency
-    //interrupt routines. So timer must be fully disabled. The ATMegaxxx0 has three of these
-    //registers, but the ATMega162 doesn't, so I've had to improvise and use other registers
-    //instead. See PinMappings.h for the ATMega162 to see which registers have been #defined
-    //as GPIORx.
-    TIMSK &= ~(_BV(TOIE0) | _BV(OCIE0));
-    TCCR0 = 0;
-#endif
+    //Start the system tick timebase
+    configureSystemTick();
 
     //Ensure SPI is disabled
     SPI_disable();
@@ -420,6 +621,96 @@ void storeEEPROM(){
     EEPROM_writeAccelTable(cmd.accelTable[DC],AccelTableLength,AccelTable2_Address);
 }
 
+unsigned int checksumUpdate(unsigned int crc, const void* data, unsigned int len){
+    const byte* bytes = (const byte*)data;
+    while (len--) {
+        crc = _crc_ccitt_update(crc, *bytes++);
+    }
+    return crc;
+}
+
+unsigned int configChecksum(byte axis){
+    //CRC-16/CCITT of the configuration stored in EEPROM which applies to this axis, in the order the config utility expects.
+    //This allows the utility to tell what has changed without having to read back the whole acceleration table, and to
+    //confirm after :T1 that the configuration really was written. The EEPROM is read back into the types used in RAM, so
+    //the bytes hashed depend on the avr-gcc type sizes (long = 4, int = 2, bool = 1, normalGotoSpeed is an int). The
+    //config utility hard-codes these sizes in checksumFields, so the two must be changed together.
+    unsigned int crc = 0xFFFF;
+    unsigned long longVal;
+    unsigned int intVal;
+    byte byteVal;
+    bool boolVal;
+    longVal = EEPROM_readLong((axis == RA) ? aVal1_Address : aVal2_Address);
+    crc = checksumUpdate(crc, &longVal, sizeof(longVal));
+    longVal = EEPROM_readLong((axis == RA) ? bVal1_Address : bVal2_Address);
+    crc = checksumUpdate(crc, &longVal, sizeof(longVal));
+    longVal = EEPROM_readLong((axis == RA) ? sVal1_Address : sVal2_Address);
+    crc = checksumUpdate(crc, &longVal, sizeof(longVal));
+    intVal = EEPROM_readInt((axis == RA) ? IVal1_Address : IVal2_Address);
+    crc = checksumUpdate(crc, &intVal, sizeof(intVal));
+    intVal = EEPROM_readByte((axis == RA) ? RAGoto_Address : DECGoto_Address); //normalGotoSpeed
+    crc = checksumUpdate(crc, &intVal, sizeof(intVal));
+    boolVal = EEPROM_readByte((axis == RA) ? RAReverse_Address : DECReverse_Address) ? CMD_REVERSE : CMD_FORWARD; //encodeDirection
+    crc = checksumUpdate(crc, &boolVal, sizeof(boolVal));
+    byteVal = EEPROM_readByte(Driver_Address);
+    crc = checksumUpdate(crc, &byteVal, sizeof(byteVal));
+    byteVal = EEPROM_readByte(Microstep_Address);
+    crc = checksumUpdate(crc, &byteVal, sizeof(byteVal));
+    boolVal = !EEPROM_readByte(GearEnable_Address); //disableGearChange
+    crc = checksumUpdate(crc, &boolVal, sizeof(boolVal));
+    boolVal = !EEPROM_readByte(AdvHCEnable_Address); //allowAdvancedHCDetection
+    crc = checksumUpdate(crc, &boolVal, sizeof(boolVal));
+    byteVal = EEPROM_readByte(SpeedFactor_Address);
+    crc = checksumUpdate(crc, &byteVal, sizeof(byteVal));
+    intVal = EEPROM_readInt(DecBacklash_Address);
+    crc = checksumUpdate(crc, &intVal, sizeof(intVal));
+    unsigned int address = (axis == RA) ? AccelTable1_Address : AccelTable2_Address;
+    for (byte i = 0; i < AccelTableLength; i++) {
+        //Read an entry at a time rather than the whole table to save RAM.
+        AccelTableStruct entry;
+        EEPROM_readAccelTable(&entry, 1, address);
+        address = address + sizeof(unsigned int) + sizeof(byte);
+        crc = checksumUpdate(crc, &entry.speed, sizeof(entry.speed));
+        crc = checksumUpdate(crc, &entry.repeats, sizeof(entry.repeats));
+    }
+    return crc;
+}
+
+#ifdef MOUNT_PRESETS
+bool loadMountPreset(byte preset){
+    if (preset >= MountPresetCount) {
+        return false; //No such preset.
+    }
+    MountPresetStruct config;
+    memcpy_P(&config, &mountPreset[preset], sizeof(MountPresetStruct));
+    cmd_setaVal(RA, config.aVal[RA]);
+    cmd_setaVal(DC, config.aVal[DC]);
+    cmd_setbVal(RA, config.bVal[RA]);
+    cmd_setbVal(DC, config.bVal[DC]);
+    cmd_setsVal(RA, config.sVal[RA]);
+    cmd_setsVal(DC, config.sVal[DC]);
+    cmd_setsideIVal(RA, config.siderealIVal[RA]);
+    cmd_setsideIVal(DC, config.siderealIVal[DC]);
+    cmd.normalGotoSpeed[RA] = config.normalGotoSpeed[RA];
+    cmd.normalGotoSpeed[DC] = config.normalGotoSpeed[DC];
+    encodeDirection[RA] = config.encodeDirection[RA];
+    encodeDirection[DC] = config.encodeDirection[DC];
+    driverVersion = config.driverVersion;
+    microstepConf = config.microstepConf;
+    disableGearChange = config.disableGearChange;
+    allowAdvancedHCDetection = config.allowAdvancedHCDetection;
+    canJumpToHighspeed = (microstepConf >= 8) && !disableGearChange; //Gear change is enabled if the microstep mode can change by a factor of 8.
+    cmd_setst4SpeedFactor(config.st4SpeedFactor);
+    cmd_setst4DecBacklash(0);
+    memcpy_P(cmd.accelTable[RA], mountPresetAccelTable[config.accelTable[RA]], sizeof(AccelTableStruct)*AccelTableLength);
+    memcpy_P(cmd.accelTable[DC], mountPresetAccelTable[config.accelTable[DC]], sizeof(AccelTableStruct)*AccelTableLength);
+    //Store the whole configuration, including the ID string so that a blank EEPROM is also made valid.
+    buildEEPROM();
+    storeEEPROM();
+    return true;
+}
+#endif
+
 
 
 
@@ -715,6 +1006,63 @@ int main(void) {
                 }
             }
             
+            //Dither handling
+            //
+            if (ditherActive[RA]) {
+                //If RA is running off its tracking rate to perform a dither
+                if ((readyToGo[RA] != 2) || (cmd.stopped[RA] == CMD_STOPPED)) {
+                    //Tracking has been stopped or reconfigured, so the dither is abandoned.
+                    ditherActive[RA] = false;
+                } else {
+                    byte oldSREG = SREG;
+                    cli(); //The next bit needs to be atomic as the motor is running
+                    unsigned long jVal = cmd.jVal[RA];
+                    SREG = oldSREG;
+                    long remaining = (cmd.dir[RA] == CMD_FORWARD) ? (long)(ditherEndPosn[RA] - jVal) : (long)(jVal - ditherEndPosn[RA]);
+                    if (remaining <= 0) {
+                        //Once we have done the required number of steps, return to tracking.
+                        cmd_setIVal(RA, ditherTrackingIVal);
+                        motorStartRA();
+                        ditherActive[RA] = false;
+                    }
+                }
+            }
+            if (ditherActive[DC] && !approachPending[DC] && (readyToGo[DC] == 0) && (cmd.stopped[DC] == CMD_STOPPED)) {
+                //Once the Dec dither movement has finished, the axis is done.
+                ditherActive[DC] = false;
+            }
+            if (approachPending[RA] && (readyToGo[RA] == 0) && (cmd.stopped[RA] == CMD_STOPPED)) {
+                //Once an overshooting goto is done, come back to the target from the preferred direction.
+                approachMode(RA);
+            }
+            if (approachPending[DC] && (readyToGo[DC] == 0) && (cmd.stopped[DC] == CMD_STOPPED)) {
+                //Once an overshooting goto is done, come back to the target from the preferred direction.
+                approachMode(DC);
+            }
+            if (!ditherSettled) {
+                //Check whether both axes are steady. RA must be stopped or running at its target speed, Dec must have finished moving.
+                byte oldSREG = SREG;
+                cli(); //We are reading motor ISR values, so ensure we are atomic.
+                unsigned int currentSpeed = currentMotorSpeed(RA);
+                SREG = oldSREG; //End atomic
+                unsigned long ticks = systemTicks();
+                if (ditherActive[RA] || ditherActive[DC] || ((cmd.stopped[RA] != CMD_STOPPED) && (currentSpeed != cmd.currentIVal[RA]))) {
+                    //Still moving, so restart the settle time.
+                    ditherSettleStart = ticks;
+                } else if ((ticks - ditherSettleStart) >= ditherSettleTime) {
+                    //Steady for long enough, so we are now settled.
+                    ditherSettled = true;
+                }
+            }
+            
+#ifdef PERSIST_GUIDE_RATE
+            if (guideRateChanged && EEPROM_isReady()) {
+                //Save any new guide rate in the background. Waiting until the EEPROM is ready means the write never holds up the loop.
+                guideRateChanged = false;
+                EEPROM_writeByte(cmd.st4SpeedFactor, SpeedFactor_Address); //Only actually written if changed, to save EEPROM wear.
+            }
+#endif
+            
             //Check both axes - loop unraveled for speed efficiency - lots of Flash available.
             if(readyToGo[RA]==1){
                 //If we are ready to begin a movement which requires the motors to be reconfigured
@@ -744,6 +1092,10 @@ int main(void) {
                     }
                     if(GVal & 1){
                         //This is the function that enables a slew type move.
+                        if ((GVal == 1) && (cmd.IVal[RA] >= (cmd.siderealIVal[RA] >> 1))) {
+                            //A low speed slew at up to 2x sidereal is tracking. Gotos should be approached from the same direction.
+                            approachDir[RA] = cmd.dir[RA];
+                        }
                         slewMode(RA); //Slew type
                         readyToGo[RA] = 2;
                     } else {
@@ -915,6 +1267,9 @@ int main(void) {
         ///////////
         }
         
+        //Keep any tracking axes locked to the system tick.
+        trackingSupervisor(RA);
+        trackingSupervisor(DC);
         
     }//End of run loop
 }
@@ -953,6 +1308,11 @@ bool decodeCommand(char command, char* buffer){ //each command is axis specific.
             break;
         case 'f': //read-only, return the fVal (axis status)
             responseData = cmd_fVal(axis); //response to the f command is stored in the fVal function for that axis.
+            if (approachPending[axis]) {
+                //Between the overshoot and the approach, the goto is still running as far as the host is concerned.
+                responseData &= ~(1 << 8);
+                responseData |=  (1 << 4);
+            }
             break;
         case 'j': //read-only, return the jVal (current position)
             oldSREG = SREG; 
@@ -963,10 +1323,12 @@ bool decodeCommand(char command, char* buffer){ //each command is axis specific.
         case 'K': //stop the motor, return empty response
             motorStop(axis,0); //normal ISR based deceleration trigger.
             readyToGo[axis] = 0;
+            approachPending[axis] = false;
             break;
         case 'L':
             motorStop(axis,1); //emergency axis stop.
             motorDisable(axis); //shutdown driver power.
+            approachPending[axis] = false;
             break;
         case 'G': //set mode and direction, return empty response
             /*if (packetIn[0] == '0'){
@@ -975,11 +1337,86 @@ bool decodeCommand(char command, char* buffer){ //each command is axis specific.
             cmd_setGVal(axis, (buffer[0] - '0')); //Store the current mode for the axis
             cmd_setDir(axis, (buffer[1] != '0') ? CMD_REVERSE : CMD_FORWARD); //Store the current direction for that axis
             readyToGo[axis] = 0;
+            approachPending[axis] = false;
             break;
         case 'H': //set goto position, return empty response (this sets the number of steps to move from current position if in goto mode)
             cmd_setHVal(axis, synta_hexToLong(buffer)); //set the goto position container (convert string to long first)
             readyToGo[axis] = 0;
             break;
+        case 'P': //set the ST-4 guide rate, return empty response
+            //There is only one guide rate which is common to both axes, and it is set by :P1. EQMOD also sends :P2 with the same
+            //rate, which is accepted. A different rate for DEC cannot be honoured, so is refused rather than overwriting the RA rate.
+            responseData = buffer[0] - '0';
+            if (responseData >= sizeof(guideRateFactors)) {
+                command = '\0'; //Invalid rate. Force sending of error packet!.
+            } else if (axis == DC) {
+                if (guideRateFactors[responseData] != cmd.st4SpeedFactor) {
+                    command = '\0'; //Rate differs from the common rate. Force sending of error packet!.
+                }
+            } else {
+                cmd_setst4SpeedFactor(guideRateFactors[responseData]); //store st4 speed factor
+                if (cmd.st4Mode == CMD_ST4_DEFAULT) {
+                    //Recalculate the guide speeds. Tracking is unaffected, and any guide pulse in progress finishes at the old rate.
+                    Commands_configureST4Speed(CMD_ST4_DEFAULT);
+                }
+#ifdef PERSIST_GUIDE_RATE
+                guideRateChanged = true; //The main loop will save the new rate when the EEPROM is free.
+#endif
+            }
+            responseData = 0;
+            break;
+        case 'U': //dither the axis by a signed number of steps, return empty response
+            responseData = synta_hexToLong(buffer); //convert string to long first
+            if (responseData & 0x800000) {
+                responseData |= 0xFF000000; //Sign extend the 24bit offset
+            }
+            if (!ditherMode(axis, (long)responseData)) {
+                command = '\0'; //Axis not in a state which can be dithered. Force sending of error packet!.
+            }
+            responseData = 0;
+            break;
+        case 'u': //read-only, return whether the mount has settled after the last dither
+            responseData = ditherSettled;
+            break;
+        case 'W': //set an extended setting, return empty response. Lowest byte is the setting, upper two bytes are the value.
+            //Synta uses :W to set features (PPEC, encoders, full current, etc.) with codes below 0x80. AstroEQ doesn't have those
+            //features, so they are rejected, and our own settings start from 0x81 so that a Synta code never changes one of them.
+            responseData = synta_hexToLong(buffer); //convert string to long first
+            switch ((byte)responseData) {
+                case 0x81: //settle time in ms after a dither
+                    ditherSettleTime = (unsigned int)(responseData >> 8);
+                    break;
+                case 0x82: //goto overshoot for anti-backlash approach
+                    approachOvershoot[axis] = (unsigned int)(responseData >> 8);
+                    break;
+                case 0x83: //preferred goto approach direction
+                    approachDir[axis] = (responseData >> 8) ? CMD_REVERSE : CMD_FORWARD;
+                    break;
+                case 0x84: //maximum speed for the next goto
+                    responseData = responseData >> 8;
+                    if (responseData && (responseData < cmd.accelTable[axis][AccelTableLength-1].speed)) {
+                        //Limit the speed to the largest speed in the acceleration table, as for :I
+                        responseData = cmd.accelTable[axis][AccelTableLength-1].speed;
+                    }
+                    gotoSpeedOverride[axis] = responseData;
+                    break;
+                case 0x85: //acceleration ramp scale for the next goto in 1/16ths
+                    if ((responseData >> 8) > 64) {
+                        command = '\0'; //Scale out of range (max. 4x the table length). Force sending of error packet!.
+                    } else {
+                        gotoRampScaleOverride[axis] = (byte)(responseData >> 8);
+                    }
+                    break;
+                default:
+                    command = '\0'; //Unknown setting, or a Synta feature code. Force sending of error packet!.
+                    break;
+            }
+            responseData = 0;
+            break;
+        case 'M': //set the goto brake point, return empty response (this sets how many steps before the target the goto starts to decelerate)
+            gotoBrakeLength[axis] = synta_hexToLong(buffer); //store the brake increment for the next goto. Validated against the acceleration profile when the goto begins.
+            readyToGo[axis] = 0;
+            break;
         case 'I': //set slew speed, return empty response (this sets the speed to move at if in slew mode)
             responseData = synta_hexToLong(buffer); //convert string to long first
             if (responseData < cmd.accelTable[axis][AccelTableLength-1].speed) {
@@ -988,6 +1425,7 @@ bool decodeCommand(char command, char* buffer){ //each command is axis specific.
             }
             cmd_setIVal(axis, responseData); //set the speed container
             responseData = 0;
+            ditherActive[axis] = false; //A new speed overrides any dither in progress.
             if (readyToGo[axis] == 2) {
                 //If we are in a running mode which allows speed update without motor reconfiguration
                 motorStart(axis); //Simply update the speed.
@@ -1139,6 +1577,17 @@ bool decodeCommand(char command, char* buffer){ //each command is axis specific.
                             command = '\0'; //If the address out of range, force an error response packet.
                         }
                         break;
+#ifdef MOUNT_PRESETS
+                    case 'V': //load a built-in mount preset, return empty response
+                        //The preset is copied into the active configuration and stored to EEPROM in one go.
+                        if (!(progMode & 2) || !loadMountPreset(synta_hexToByte(buffer))) {
+                            command = '\0'; //If not in store mode or the preset doesn't exist, force an error response packet.
+                        }
+                        break;
+#endif
+                    case 'v': //return the checksum of the configuration stored in EEPROM
+                        responseData = configChecksum(axis);
+                        break;
                     case 'T': //set mode, return empty response
                         if (progMode & 2) {
                         //proceed with EEPROM write
@@ -1154,7 +1603,7 @@ bool decodeCommand(char command, char* buffer){ //each command is axis specific.
                         }
                         break;
                     //---------------------------------------------------
-                    default: //Return empty response (deals with commands that don't do anything before the response sent (i.e 'J', 'R'), or do nothing at all (e.g. 'M') )
+                    default: //Return empty response (deals with commands that don't do anything before the response sent (i.e 'J', 'R'), or do nothing at all)
                         break;
                 }
             }
@@ -1204,20 +1653,34 @@ void motorDisable(byte axis){
 }
 
 void slewMode(byte axis){
+    accelRampScale[axis] = 16; //Slews always use the table profile.
     motorStart(axis); //Begin PWM
 }
 
 void gotoMode(byte axis){
-    unsigned int decelerationLength = gotoDecelerationLength[axis];
-    
-    if (cmd.highSpeedMode[axis]) {
-        //Additionally in order to maintain the same speed profile in high-speed mode, we actually increase the profile repeats by a factor of sqrt(8)
-        //compared with running in normal-speed mode. See Atmel AVR466 app note for calculation.
-        decelerationLength = decelerationLength * 3; //multiply by 3 as it is approx sqrt(8)
+    //Apply any speed and acceleration overrides. These only last for this goto.
+    unsigned int gotoSpeed = cmd.normalGotoSpeed[axis];
+    if (gotoSpeedOverride[axis]) {
+        gotoSpeed = gotoSpeedOverride[axis];
+        gotoSpeedOverride[axis] = 0;
     }
+    accelRampScale[axis] = gotoRampScaleOverride[axis] ? gotoRampScaleOverride[axis] : 16;
+    gotoRampScaleOverride[axis] = 0;
+    
+    //The ramp is timed rather than counted in steps, so the deceleration length accounts for the gear and ramp scale of this move.
+    unsigned long decelerationLength = calculateDecelerationLength(axis, gotoSpeed);
     
     byte dirMagnitude = abs(cmd.stepDir[axis]);
     byte dir = cmd.dir[axis];
+    
+    approachTarget[axis] = cmd.jVal[axis] + ((dir == CMD_REVERSE) ? -cmd.HVal[axis] : cmd.HVal[axis]);
+    if (approachOvershoot[axis] && (dir != approachDir[axis]) && !((axis == DC) && ditherActive[DC])) {
+        //If the goto would finish against the preferred direction, go past the target so that we can come back to it from the
+        //other side. This takes up the backlash in the preferred direction, so tracking is stable as soon as we arrive.
+        //Dither gotos are skipped as ditherMode() has already compensated them for backlash using the ST4 DEC backlash.
+        cmd_setHVal(axis, cmd.HVal[axis] + approachOvershoot[axis]);
+        approachPending[axis] = true;
+    }
 
     if (cmd.HVal[axis] < 2*dirMagnitude){
         cmd_setHVal(axis,2*dirMagnitude);
@@ -1225,21 +1688,41 @@ void gotoMode(byte axis){
 
     decelerationLength = decelerationLength * dirMagnitude;
     //deceleration length is here a multiple of stepDir.
+    unsigned long rampLength = decelerationLength; //This is the minimum safe deceleration distance for the profile.
+    unsigned long brakeLength = gotoBrakeLength[axis];
+    gotoBrakeLength[axis] = 0; //Like the overrides above, the brake point only applies to this goto, so a stale one can't slow later gotos.
     unsigned long HVal = cmd.HVal[axis];
     unsigned long halfHVal = (HVal >> 1);
-    unsigned int gotoSpeed = cmd.normalGotoSpeed[axis];
     if(dirMagnitude == 8){
         HVal &= 0xFFFFFFF8; //clear the lower bits to avoid overshoot.
     }
     if(dirMagnitude == 8){
         halfHVal &= 0xFFFFFFF8; //clear the lower bits to avoid overshoot.
     }
+    if(dirMagnitude == 8){
+        brakeLength &= 0xFFFFFFF8; //brake point must also be a multiple of stepDir.
+    }
     //HVal and halfHVal are here a multiple of stepDir
+    if (brakeLength > decelerationLength) {
+        //If the host has asked to start braking earlier than the ramp requires, then use its brake point. Anything
+        //shorter than the ramp would overshoot, so is replaced with the ramp length.
+        decelerationLength = brakeLength;
+    }
     if (halfHVal < decelerationLength) {
         decelerationLength = halfHVal;
     }
+    if (decelerationLength > rampLength) {
+        //If braking starts before the ramp needs to, we decelerate to the stop speed and crawl to the landing point.
+        gotoBrakeSpeed[axis] = cmd.stopSpeed[axis];
+    } else {
+        //Otherwise decelerate straight to a stop.
+        gotoBrakeSpeed[axis] = cmd.stopSpeed[axis]+1;
+    }
+    unsigned long jVal = cmd.jVal[axis];
+    unsigned long targetPosn = jVal + ((dir == CMD_REVERSE) ? -HVal : HVal); //current position + relative change
+    gotoLandingPosn[axis] = targetPosn - cmd.stepDir[axis]; //the motor takes one more step once it is told to stop, so land one step early.
     HVal -= decelerationLength;
-    gotoPosn[axis] = cmd.jVal[axis] + ((dir == CMD_REVERSE) ? -HVal : HVal); //current position + relative change - deceleration region
+    gotoPosn[axis] = jVal + ((dir == CMD_REVERSE) ? -HVal : HVal); //current position + relative change - deceleration region
     
     cmd_setIVal(axis, gotoSpeed);
     clearGotoDecelerating(axis);
@@ -1247,6 +1730,86 @@ void gotoMode(byte axis){
     motorStart(axis); //Begin PWM
 }
 
+void approachMode(byte axis){
+    approachPending[axis] = false;
+    byte dir = approachDir[axis];
+    unsigned long jVal = cmd.jVal[axis];
+    unsigned long distance = (dir == CMD_REVERSE) ? (jVal - approachTarget[axis]) : (approachTarget[axis] - jVal);
+    if ((long)distance <= 0) {
+        return; //Already at the target.
+    }
+    //Return to the target with a low speed goto in the preferred direction.
+    cmd_setGVal(axis, 2);
+    cmd_setDir(axis, dir);
+    cmd_setHVal(axis, distance);
+    cmd_setGotoEn(axis, CMD_ENABLED);
+    readyToGo[axis] = 1; //The goto is started from the main loop.
+}
+
+bool ditherMode(byte axis, long offset){
+    if (axis == RA) {
+        //RA is dithered by running faster or slower than tracking for a time, so it never changes direction and no backlash is introduced.
+        if ((readyToGo[RA] != 2) || (cmd.stopped[RA] == CMD_STOPPED)) {
+            return false; //RA can only be dithered while tracking
+        }
+        if (!ditherActive[RA]) {
+            ditherTrackingIVal = cmd.IVal[RA]; //Keep track of the tracking speed to return to.
+        }
+        //The offset is in axis position, so whether it means getting ahead of or falling behind tracking depends on the tracking direction.
+        bool tracksForward = (cmd.dir[RA] == CMD_FORWARD);
+        unsigned long distance = (offset < 0) ? -offset : offset;
+        unsigned long steps;
+        if ((offset > 0) == tracksForward) {
+            //Get ahead by running at 3x tracking speed. In the time taken for n steps, tracking would have done n/3 steps, so we gain 2n/3.
+            //n is rounded up, so an odd offset is overshot by up to a third of a step rather than undershot.
+            steps = distance + ((distance + 1) >> 1);
+            cmd_setIVal(RA, ditherTrackingIVal / 3);
+        } else {
+            //Fall behind by running at 1/3 tracking speed. In the time taken for n steps, tracking would have done 3n steps, so we lose 2n.
+            if (ditherTrackingIVal > (0xFFFF / 3)) {
+                return false; //Too slow already to slow down any further.
+            }
+            steps = (distance + 1) >> 1; //Rounded up (overshooting an odd offset by one step) so that a 1 step offset still moves.
+            cmd_setIVal(RA, ditherTrackingIVal * 3);
+        }
+        if (steps == 0) {
+            cmd_setIVal(RA, ditherTrackingIVal);
+            return true; //Nothing to do (zero offset).
+        }
+        byte oldSREG = SREG;
+        cli(); //The next bit needs to be atomic as the motor is running
+        ditherEndPosn[RA] = cmd.jVal[RA] + (tracksForward ? steps : -steps);
+        SREG = oldSREG;
+        ditherActive[RA] = true;
+        motorStartRA(); //Update the speed. The dither is completed from the main loop.
+    } else {
+        //Dec is dithered with a low speed goto, taking up backlash if the direction reverses.
+        if ((readyToGo[DC] != 0) || (cmd.stopped[DC] != CMD_STOPPED)) {
+            return false; //Dec can only be dithered while stationary
+        }
+        if (offset == 0) {
+            return true; //Nothing to do.
+        }
+        byte dir = (offset < 0) ? CMD_REVERSE : CMD_FORWARD;
+        unsigned long steps = (offset < 0) ? -offset : offset;
+        if (dir != cmd.dir[DC]) {
+            //Reversing direction, so add on the backlash. The position is moved back to match so that only the requested offset is seen.
+            unsigned long backlash = cmd.st4DecBacklash;
+            steps = steps + backlash;
+            cmd_setjVal(DC, cmd.jVal[DC] + ((dir == CMD_REVERSE) ? backlash : -backlash));
+        }
+        cmd_setGVal(DC, 2); //Low speed goto
+        cmd_setDir(DC, dir);
+        cmd_setHVal(DC, steps);
+        cmd_setGotoEn(DC, CMD_ENABLED);
+        ditherActive[DC] = true;
+        readyToGo[DC] = 1; //The goto is started from the main loop.
+    }
+    ditherSettled = false;
+    ditherSettleStart = systemTicks();
+    return true;
+}
+
 inline void timerEnable(byte motor) {
     if (motor == RA) {
         timerPrescalarRegister(RA, timerPrescalarRegister(RA) & ~((1<<CSn2) | (1<<CSn1)) );//00x
@@ -1307,7 +1870,7 @@ void motorStartRA(){
     
     if(cmd.stopped[RA]) { //if stopped, configure timers
         irqToNextStep(RA, 1);
-        accelTableRepeatsLeft[RA] = cmd.accelTable[RA][0].repeats; //If we are stopped, we must do the required number of repeats for the first entry in the speed table.
+        accelTableTicksLeft[RA] = accelTableTicks(RA, 0); //If we are stopped, we must spend the required time at the first entry in the speed table.
         accelTableIndex[RA] = 0;
         distributionSegment(RA, 0);
         timerCountRegister(RA, 0);
@@ -1348,7 +1911,7 @@ void motorStartDC(){
     
     if(cmd.stopped[DC]) { //if stopped, configure timers
         irqToNextStep(DC, 1);
-        accelTableRepeatsLeft[DC] = cmd.accelTable[DC][0].repeats; //If we are stopped, we must do the required number of repeats for the first entry in the speed table.
+        accelTableTicksLeft[DC] = accelTableTicks(DC, 0); //If we are stopped, we must spend the required time at the first entry in the speed table.
         accelTableIndex[DC] = 0;
         distributionSegment(DC, 0);
         timerCountRegister(DC, 0);
@@ -1456,6 +2019,10 @@ ISR(TIMER3_CAPT_vect) {
     if (irqToNext == 0) {
         //Once the required number of interrupts have occurred...
         
+        //
+        // Top half - time critical. Loads the step period which the bottom half computed one step ahead, and toggles the step pin.
+        //
+        
         //First update the interrupt base rate using our distribution array. 
         //This affords a more accurate sidereal rate by dithering the interrupt rate to get higher resolution.
         byte timeSegment = distributionSegment(DC); //Get the current time segment
@@ -1472,10 +2039,24 @@ ISR(TIMER3_CAPT_vect) {
         unsigned int currentSpeed = currentMotorSpeed(DC); //Get the current motor speed
         irqToNextStep(DC, currentSpeed); //Update interrupts to next step to be the current speed in case it changed (accel/decel)
         
-        if (getPinValue(stepPin[DC])){
-            //If the step pin is currently high...
-            
+        bool stepPinHigh = getPinValue(stepPin[DC]);
+        if (stepPinHigh) {
             setPinValue(stepPin[DC],LOW); //set step pin low to complete step
+        } else {
+            setPinValue(stepPin[DC],HIGH); //Set it high to start next step.
+        }
+        
+        //
+        // Bottom half - runs with interrupts enabled so that the serial port and the other axis are not held off.
+        //
+        
+        //Mask our own vector so that the bottom half cannot be re-entered. If the next interrupt arrives in the meantime its flag
+        //remains set and the top half will run as soon as we unmask again.
+        interruptControlRegister(DC, interruptControlRegister(DC) & ~interruptControlBitMask(DC));
+        sei();
+        
+        if (stepPinHigh){
+            //If the step pin was high, we have just completed a step...
             
             //Then increment our encoder value by the required amount of encoder values per step (1 for low speed, 8 for high speed)
             //and in the correct direction (+ = forward, - = reverse).
@@ -1483,13 +2064,18 @@ ISR(TIMER3_CAPT_vect) {
             jVal = jVal + cmd.stepDir[DC];
             cmd.jVal[DC] = jVal;
             
-            if(gotoRunning(DC) && !gotoDecelerating(DC)){
-                //If we are currently performing a Go-To and haven't yet started deceleration...
-                if (gotoPosn[DC] == jVal){ 
-                    //If we have reached the start deceleration marker...
-                    setGotoDecelerating(DC); //Mark that we have started deceleration.
-                    cmd.currentIVal[DC] = cmd.stopSpeed[DC]+1; //Set the new target speed to slower than the stop speed to cause deceleration to a stop.
-                    accelTableRepeatsLeft[DC] = 0;
+            if(gotoRunning(DC)){
+                if(!gotoDecelerating(DC)){
+                    //If we are currently performing a Go-To and haven't yet started deceleration...
+                    if (gotoPosn[DC] == jVal){ 
+                        //If we have reached the start deceleration marker...
+                        setGotoDecelerating(DC); //Mark that we have started deceleration.
+                        cmd.currentIVal[DC] = gotoBrakeSpeed[DC]; //Set the new target speed to the brake speed to cause deceleration.
+                        accelTableTicksLeft[DC] = 0;
+                    }
+                } else if (gotoLandingPosn[DC] == jVal) {
+                    //If we have crawled to the landing point...
+                    cmd.currentIVal[DC] = cmd.stopSpeed[DC]+1; //Set the new target speed to slower than the stop speed to cause a stop.
                 }
             } 
             
@@ -1505,13 +2091,12 @@ ISR(TIMER3_CAPT_vect) {
                 timerDisable(DC);  //And stop the interrupt timer.
             } 
         } else {
-            //If the step pin is currently low...
-            setPinValue(stepPin[DC],HIGH); //Set it high to start next step.
+            //If the step pin was low, we have just started the next step...
             
             //If the current speed is not the target speed, then we are in the accel/decel phase. So...
-            byte repeatsReqd = accelTableRepeatsLeft[DC]; //load the number of repeats left for this accel table entry
-            if (repeatsReqd == 0) { 
-                //If we have done enough repeats for this entry
+            long ticksLeft = accelTableTicksLeft[DC] - currentSpeed; //count down the time left at this accel table entry by one step period
+            if (ticksLeft <= 0) { 
+                //If we have spent long enough at this entry
                 unsigned int targetSpeed = cmd.currentIVal[DC]; //Get the target speed
                 if (currentSpeed > targetSpeed) {
                     //If we are going too slow
@@ -1520,6 +2105,7 @@ ISR(TIMER3_CAPT_vect) {
                         //If we are at the top of the accel table
                         currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
                         accelIndex = AccelTableLength-1; //Ensure index remains in bounds.
+                        ticksLeft = 0;
                     } else {
                         //Otherwise, we need to accelerate.
                         accelIndex = accelIndex + 1; //Move to the next index
@@ -1528,14 +2114,10 @@ ISR(TIMER3_CAPT_vect) {
                         if (currentSpeed <= targetSpeed) {
                             //If the new value is too fast
                             currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
+                            ticksLeft = 0;
                         } else {
-                            //Load the new number of repeats required
-                            if (cmd.highSpeedMode[DC]) {
-                                //When in high-speed mode, we need to multiply by sqrt(8) ~= 3 to compensate for the change in steps per rev of the motor
-                                accelTableRepeatsLeft[DC] = cmd.accelTable[DC][accelIndex].repeats * 3 + 2;
-                            } else {
-                                accelTableRepeatsLeft[DC] = cmd.accelTable[DC][accelIndex].repeats;
-                            }
+                            //Add on the time required at the new entry. Any overrun of the last entry is carried so the ramp keeps to time.
+                            ticksLeft = ticksLeft + accelTableTicks(DC, accelIndex);
                         }
                     }
                 } else if (currentSpeed < targetSpeed) {
@@ -1544,6 +2126,7 @@ ISR(TIMER3_CAPT_vect) {
                     if (accelIndex == 0) {
                         //If we are at the bottom of the accel table
                         currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
+                        ticksLeft = 0;
                     } else {
                         //Otherwise, we need to decelerate.
                         accelIndex = accelIndex - 1; //Move to the next index
@@ -1552,22 +2135,25 @@ ISR(TIMER3_CAPT_vect) {
                         if (currentSpeed >= targetSpeed) {
                             //If the new value is too slow
                             currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
+                            ticksLeft = 0;
                         } else {
-                            //Load the new number of repeats required
-                            if (cmd.highSpeedMode[DC]) {
-                                //When in high-speed mode, we need to multiply by sqrt(8) ~= 3 to compensate for the change in steps per rev of the motor
-                                accelTableRepeatsLeft[DC] = cmd.accelTable[DC][accelIndex].repeats * 3 + 2;
-                            } else {
-                                accelTableRepeatsLeft[DC] = cmd.accelTable[DC][accelIndex].repeats;
-                            }
+                            //Add on the time required at the new entry. Any overrun of the last entry is carried so the ramp keeps to time.
+                            ticksLeft = ticksLeft + accelTableTicks(DC, accelIndex);
                         }
                     }
+                } else {
+                    //If we are at the target speed, there is no ramp to keep time for.
+                    ticksLeft = 0;
                 }
                 currentMotorSpeed(DC, currentSpeed); //Update the current speed in case it has changed.
-            } else {
-                //Otherwise one more repeat done.
-                accelTableRepeatsLeft[DC] = repeatsReqd - 1;
             }
+            accelTableTicksLeft[DC] = ticksLeft;
+        }
+        
+        //Unmask our vector again unless the bottom half has just stopped the timer.
+        cli();
+        if (cmd.stopped[DC] == CMD_RUNNING) {
+            interruptControlRegister(DC, interruptControlRegister(DC) | interruptControlBitMask(DC));
         }
     } else {
         //The required number of interrupts have not yet occurred...
@@ -1591,9 +2177,13 @@ ISR(TIMER1_CAPT_vect) {
     if (irqToNext == 0) {
         //Once the required number of interrupts have occurred...
         
+        //
+        // Top half - time critical. Loads the step period which the bottom half computed one step ahead, and toggles the step pin.
+        //
+        
         //First update the interrupt base rate using our distribution array. 
-        //This affords a more accurate sidereal rate by dithering the intterrupt rate to get higher resolution.
-        byte timeSegment = distributionSegment(RA); //Get the current time segement
+        //This affords a more accurate sidereal rate by dithering the interrupt rate to get higher resolution.
+        byte timeSegment = distributionSegment(RA); //Get the current time segment
         
         /* 
         byte index = ((DecimalDistnWidth-1) & timeSegment) >> 1; //Convert time segment to array index
@@ -1602,15 +2192,29 @@ ISR(TIMER1_CAPT_vect) {
         byte index = ((DecimalDistnWidth-1) << 1) & timeSegment; //Convert time segment to array index
         interruptOVFCount(RA, *(int*)((byte*)timerOVF[RA] + index)); //Update interrupt base rate.
         
-        distributionSegment(RA, timeSegment + 1); //Increment time segement for next time.
+        distributionSegment(RA, timeSegment + 1); //Increment time segment for next time.
 
         unsigned int currentSpeed = currentMotorSpeed(RA); //Get the current motor speed
         irqToNextStep(RA, currentSpeed); //Update interrupts to next step to be the current speed in case it changed (accel/decel)
         
-        if (getPinValue(stepPin[RA])){
-            //If the step pin is currently high...
-            
+        bool stepPinHigh = getPinValue(stepPin[RA]);
+        if (stepPinHigh) {
             setPinValue(stepPin[RA],LOW); //set step pin low to complete step
+        } else {
+            setPinValue(stepPin[RA],HIGH); //Set it high to start next step.
+        }
+        
+        //
+        // Bottom half - runs with interrupts enabled so that the serial port and the other axis are not held off.
+        //
+        
+        //Mask our own vector so that the bottom half cannot be re-entered. If the next interrupt arrives in the meantime its flag
+        //remains set and the top half will run as soon as we unmask again.
+        interruptControlRegister(RA, interruptControlRegister(RA) & ~interruptControlBitMask(RA));
+        sei();
+        
+        if (stepPinHigh){
+            //If the step pin was high, we have just completed a step...
             
             //Then increment our encoder value by the required amount of encoder values per step (1 for low speed, 8 for high speed)
             //and in the correct direction (+ = forward, - = reverse).
@@ -1618,13 +2222,18 @@ ISR(TIMER1_CAPT_vect) {
             jVal = jVal + cmd.stepDir[RA];
             cmd.jVal[RA] = jVal;
             
-            if(gotoRunning(RA) && !gotoDecelerating(RA)){
-                //If we are currently performing a Go-To and haven't yet started decelleration...
-                if (gotoPosn[RA] == jVal){ 
-                    //If we have reached the start decelleration marker...
-                    setGotoDecelerating(RA); //Mark that we have started decelleration.
-                    cmd.currentIVal[RA] = cmd.stopSpeed[RA]+1; //Set the new target speed to slower than the stop speed to cause decelleration to a stop.
-                    accelTableRepeatsLeft[RA] = 0;
+            if(gotoRunning(RA)){
+                if(!gotoDecelerating(RA)){
+                    //If we are currently performing a Go-To and haven't yet started decelleration...
+                    if (gotoPosn[RA] == jVal){ 
+                        //If we have reached the start decelleration marker...
+                        setGotoDecelerating(RA); //Mark that we have started decelleration.
+                        cmd.currentIVal[RA] = gotoBrakeSpeed[RA]; //Set the new target speed to the brake speed to cause decelleration.
+                        accelTableTicksLeft[RA] = 0;
+                    }
+                } else if (gotoLandingPosn[RA] == jVal) {
+                    //If we have crawled to the landing point...
+                    cmd.currentIVal[RA] = cmd.stopSpeed[RA]+1; //Set the new target speed to slower than the stop speed to cause a stop.
                 }
             } 
             
@@ -1640,13 +2249,12 @@ ISR(TIMER1_CAPT_vect) {
                 timerDisable(RA);  //And stop the interrupt timer.
             } 
         } else {
-            //If the step pin is currently low...
-            setPinValue(stepPin[RA],HIGH); //Set it high to start next step.
+            //If the step pin was low, we have just started the next step...
             
             //If the current speed is not the target speed, then we are in the accel/decel phase. So...
-            byte repeatsReqd = accelTableRepeatsLeft[RA]; //load the number of repeats left for this accel table entry
-            if (repeatsReqd == 0) { 
-                //If we have done enough repeats for this entry
+            long ticksLeft = accelTableTicksLeft[RA] - currentSpeed; //count down the time left at this accel table entry by one step period
+            if (ticksLeft <= 0) { 
+                //If we have spent long enough at this entry
                 unsigned int targetSpeed = cmd.currentIVal[RA]; //Get the target speed
                 if (currentSpeed > targetSpeed) {
                     //If we are going too slow
@@ -1655,6 +2263,7 @@ ISR(TIMER1_CAPT_vect) {
                         //If we are at the top of the accel table
                         currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
                         accelIndex = AccelTableLength-1; //Ensure index remains in bounds.
+                        ticksLeft = 0;
                     } else {
                         //Otherwise, we need to accelerate.
                         accelIndex = accelIndex + 1; //Move to the next index
@@ -1663,14 +2272,10 @@ ISR(TIMER1_CAPT_vect) {
                         if (currentSpeed <= targetSpeed) {
                             //If the new value is too fast
                             currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
+                            ticksLeft = 0;
                         } else {
-                            //Load the new number of repeats required
-                            if (cmd.highSpeedMode[RA]) {
-                                //When in high-speed mode, we need to multiply by sqrt(8) ~= 3 to compensate for the change in steps per rev of the motor
-                                accelTableRepeatsLeft[RA] = cmd.accelTable[RA][accelIndex].repeats * 3 + 2;
-                            } else {
-                                accelTableRepeatsLeft[RA] = cmd.accelTable[RA][accelIndex].repeats;
-                            }
+                            //Add on the time required at the new entry. Any overrun of the last entry is carried so the ramp keeps to time.
+                            ticksLeft = ticksLeft + accelTableTicks(RA, accelIndex);
                         }
                     }
                 } else if (currentSpeed < targetSpeed) {
@@ -1679,6 +2284,7 @@ ISR(TIMER1_CAPT_vect) {
                     if (accelIndex == 0) {
                         //If we are at the bottom of the accel table
                         currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
+                        ticksLeft = 0;
                     } else {
                         //Otherwise, we need to decelerate.
                         accelIndex = accelIndex - 1; //Move to the next index
@@ -1687,22 +2293,25 @@ ISR(TIMER1_CAPT_vect) {
                         if (currentSpeed >= targetSpeed) {
                             //If the new value is too slow
                             currentSpeed = targetSpeed; //Then the new speed is exactly the target speed.
+                            ticksLeft = 0;
                         } else {
-                            //Load the new number of repeats required
-                            if (cmd.highSpeedMode[RA]) {
-                                //When in high-speed mode, we need to multiply by sqrt(8) ~= 3 to compensate for the change in steps per rev of the motor
-                                accelTableRepeatsLeft[RA] = cmd.accelTable[RA][accelIndex].repeats * 3 + 2;
-                            } else {
-                                accelTableRepeatsLeft[RA] = cmd.accelTable[RA][accelIndex].repeats;
-                            }
+                            //Add on the time required at the new entry. Any overrun of the last entry is carried so the ramp keeps to time.
+                            ticksLeft = ticksLeft + accelTableTicks(RA, accelIndex);
                         }
                     }
+                } else {
+                    //If we are at the target speed, there is no ramp to keep time for.
+                    ticksLeft = 0;
                 }
                 currentMotorSpeed(RA, currentSpeed); //Update the current speed in case it has changed.
-            } else {
-                //Otherwise one more repeat done.
-                accelTableRepeatsLeft[RA] = repeatsReqd - 1;
             }
+            accelTableTicksLeft[RA] = ticksLeft;
+        }
+        
+        //Unmask our vector again unless the bottom half has just stopped the timer.
+        cli();
+        if (cmd.stopped[RA] == CMD_RUNNING) {
+            interruptControlRegister(RA, interruptControlRegister(RA) | interruptControlBitMask(RA));
         }
     } else {
         //The required number of interrupts have not yet occurred...
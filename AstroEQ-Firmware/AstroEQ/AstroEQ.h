@@ -15,6 +15,14 @@
 //Define the version number
 #define ASTROEQ_VER 804
 
+//Guide rate:
+//#define PERSIST_GUIDE_RATE //Uncomment this line to save guide rate changes made with the :P command to EEPROM so they persist after a reset
+
+//Mount presets:
+#if !defined(__AVR_ATmega162__) //The ATMega162 doesn't have the ~2kB of flash to spare alongside the bootloader, so only the Mega has them by default
+#define MOUNT_PRESETS //Comment out this line to remove the built-in mount presets loaded by the :V command (saves ~2kB of flash)
+#endif
+
 //Only works with ATmega162, and Arduino Mega boards (1280 and 2560)
 #if defined(__AVR_ATmega162__) || defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
 
@@ -120,6 +128,21 @@ typedef struct {
     byte repeats;
 } AccelTableStruct;
 
+typedef struct {
+    unsigned long aVal[2];
+    unsigned long bVal[2];
+    unsigned long sVal[2];
+    unsigned int siderealIVal[2];
+    byte normalGotoSpeed[2];
+    byte encodeDirection[2];
+    byte accelTable[2]; //index into mountPresetAccelTable
+    byte driverVersion;
+    byte microstepConf;
+    byte disableGearChange;
+    byte allowAdvancedHCDetection;
+    byte st4SpeedFactor;
+} MountPresetStruct;
+
 /*
  * Declare constant arrays of pin numbers
  */
@@ -141,16 +164,23 @@ static const byte modePins[2][3] = {{modePins0_0_Define,modePins1_0_Define,modeP
 bool checkEEPROM();
 void buildEEPROM();
 void storeEEPROM();
+unsigned int checksumUpdate(unsigned int crc, const void* data, unsigned int len);
+unsigned int configChecksum(byte axis);
+#ifdef MOUNT_PRESETS
+bool loadMountPreset(byte preset);
+#endif
 void systemInitialiser();
 byte standaloneModeTest();
 int main(void);
 bool decodeCommand(char command, char* packetIn);
 void calculateRate(byte axis);
-void calculateDecelerationLength (byte axis);
+unsigned long calculateDecelerationLength (byte axis, unsigned int gotoSpeed);
 void motorEnable(byte axis);
 void motorDisable(byte axis);
 void slewMode(byte axis);
 void gotoMode(byte axis);
+bool ditherMode(byte axis, long offset);
+void approachMode(byte axis);
 void motorStart(byte motor);
 void motorStartRA();
 void motorStartDC();
@@ -158,6 +188,9 @@ void motorStop(byte motor, byte emergency);
 void motorStopRA(bool emergency);
 void motorStopDC(bool emergency);
 void configureTimer();
+void configureSystemTick();
+unsigned long systemTicks();
+void trackingSupervisor(byte axis);
 void buildModeMapping(byte microsteps, byte driverVersion);
 
 
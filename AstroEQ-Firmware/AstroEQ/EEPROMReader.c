@@ -35,7 +35,7 @@ void EEPROM_readAccelTable(AccelTableStruct* table, byte elements, unsigned int
 }
 
 void EEPROM_writeByte(byte val, unsigned int address) {
-    return eeprom_write_byte((byte*) address, val);
+    return eeprom_update_byte((byte*) address, val); //only write if the value has changed to save time and wear when re-storing the config
 }
 
 void EEPROM_writeInt(unsigned int val, unsigned int address) {
@@ -56,6 +56,10 @@ void EEPROM_writeString(const char* string, byte len, unsigned int address) {
     }
 }
 
+bool EEPROM_isReady() {
+    return eeprom_is_ready(); //true if a write can begin without waiting for the previous one to complete
+}
+
 void EEPROM_writeAccelTable(AccelTableStruct* table, byte elements, unsigned int address){
     for(byte i = 0; i < elements; i++) {
         EEPROM_writeInt(table[i].speed,address);
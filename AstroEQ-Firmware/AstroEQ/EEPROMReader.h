@@ -14,5 +14,6 @@ void EEPROM_writeInt(unsigned int val,unsigned int address);
 void EEPROM_writeLong(unsigned long val,unsigned int address);
 void EEPROM_writeString(const char* string, byte len, unsigned int address);
 void EEPROM_writeAccelTable(AccelTableStruct* table, byte elements, unsigned int address);
+bool EEPROM_isReady();
 
 #endif //__EEPROM_H__
@@ -0,0 +1,417 @@
+/*
+  Mount Preset Generator
+
+  Builds MountPresets.h from the mount configuration files used by the config utility
+  (AstroEQ-ConfigUtility/mounts/*.conf). The goto multiplier (:z) is stored in the .conf
+  file as-is, and the acceleration tables are calculated in exactly the same way as the
+  config utility does when programming a board, so loading a preset with the :V command
+  gives the same EEPROM contents as uploading the .conf file would. Each preset is checked
+  against what the config utility would store before the header is written.
+
+  This is run as a pre-build step by Atmel Studio through Windows Script Host:
+    cscript //nologo GenerateMountPresets.js <mounts directory> <output file>
+  It can also be run with node using the same arguments.
+*/
+
+var ACCEL_TABLE_LEN = 64;
+var MAX_REPEATS = 85;
+var MIN_IVAL = 300; //normal minimum
+var DEFAULT_ST4_RATE = 0.25;
+
+/*
+ * File Helpers (Windows Script Host or node)
+ */
+
+var isWSH = (typeof WScript !== "undefined");
+var fso = isWSH ? new ActiveXObject("Scripting.FileSystemObject") : null;
+var fs = isWSH ? null : require("fs");
+
+function getArgs() {
+    var args = [];
+    if (isWSH) {
+        for (var i = 0; i < WScript.Arguments.length; i++) {
+            args.push(WScript.Arguments(i));
+        }
+    } else {
+        args = process.argv.slice(2);
+    }
+    return args;
+}
+
+function listConfFiles(dir) {
+    var files = [];
+    if (isWSH) {
+        var e = new Enumerator(fso.GetFolder(dir).Files);
+        for (; !e.atEnd(); e.moveNext()) {
+            files.push(e.item().Name);
+        }
+    } else {
+        files = fs.readdirSync(dir);
+    }
+    var confFiles = [];
+    for (var i = 0; i < files.length; i++) {
+        if (/\.conf$/i.test(files[i])) {
+            confFiles.push(files[i]);
+        }
+    }
+    confFiles.sort(); //Preset numbering follows the file names so it is stable between builds.
+    return confFiles;
+}
+
+function readFile(path) {
+    if (isWSH) {
+        var file = fso.OpenTextFile(path, 1);
+        var text = file.AtEndOfStream ? "" : file.ReadAll();
+        file.Close();
+        return text;
+    }
+    return fs.readFileSync(path, "utf8");
+}
+
+function writeFile(path, text) {
+    if (isWSH) {
+        var file = fso.CreateTextFile(path, true);
+        file.Write(text);
+        file.Close();
+    } else {
+        fs.writeFileSync(path, text);
+    }
+}
+
+function log(text) {
+    if (isWSH) {
+        WScript.Echo(text);
+    } else {
+        console.log(text);
+    }
+}
+
+function fail(text) {
+    log("GenerateMountPresets: error: " + text);
+    if (isWSH) {
+        WScript.Quit(1);
+    } else {
+        process.exit(1);
+    }
+}
+
+/*
+ * Config Calculations (ported from the config utility)
+ */
+
+function javaRound(x) {
+    return Math.floor(x + 0.5); //Math.round() in Java.
+}
+
+function calculateMinimumIVal(aVal) {
+    var maxIVal = (86164.0905*8000000.0)/(aVal*480.0);
+    return Math.min(MIN_IVAL, Math.floor(maxIVal)); //if the maximum possible is smaller than our soft limit, change the minimum.
+}
+
+function calculateGotoFactor(IVal, Multiplier, microstepping, minIVal) {
+    if ((Multiplier == 0) || (Multiplier > 255) || (IVal > 1200) || (IVal < minIVal)) {
+        return null;
+    }
+    var Factor = javaRound(IVal / Multiplier);
+    if (microstepping) {
+        Factor *= 8; //Goto speed is 8x larger for microstepping
+    }
+    return Math.min(Factor, 1200); //limit max speed
+}
+
+function calculateGotoMultiplier(IVal, Factor, microstepping, minIVal) {
+    if (microstepping) {
+        Factor /= 8; //Goto speed is 8x larger for microstepping
+    }
+    if ((Factor < 1) || (IVal > 1200) || (IVal < minIVal)) {
+        return null;
+    }
+    var Multiplier = javaRound(IVal / Factor);
+    if (Multiplier > 255) {
+        return null; //multiplier not in range
+    }
+    if (Multiplier == 0) {
+        Multiplier = 1; //Must not be zero.
+    }
+    return Multiplier;
+}
+
+function generateAccelerationTable(IVal, bVal) {
+    var IVals = [];
+    var repeats = [];
+    var startIVal = Math.floor(IVal/2);
+    var stepPerSec = bVal;
+    var secPerStep = 1.0 / bVal;
+
+    var stopIVal = 2;
+    var accelTime = 4.0;
+
+    while (stopIVal <= 8) {
+
+        var startSpeed = (stepPerSec / startIVal);
+        var endSpeed = (stepPerSec / stopIVal);
+
+        //Calculate acceleration parameters for linear profile -> Y = mX + c
+        var m = (endSpeed - startSpeed) / accelTime;
+        var c = startSpeed;
+
+        //Start us off at the start IVal
+        var currentIndex = 0;
+        var currentTime = 0;
+        IVals[currentIndex] = startIVal; //First IVal is the startIVal
+        repeats[currentIndex] = 1;       //And we will have 1 step of that.
+        var currentSpeed = startSpeed;   //Current speed is the starting speed.
+
+        while (currentIndex < ACCEL_TABLE_LEN-1) {
+            //Move time on as we have performed another step.
+            currentTime = currentTime + (secPerStep * IVals[currentIndex]);
+            //Calculate the required velocity at this moment in time
+            var requiredVelocity = m * currentTime + c;
+            if ((currentSpeed >= requiredVelocity) && (repeats[currentIndex] < MAX_REPEATS)) {
+                //If we are going faster than required, and we have not used up all of our repeats, do another step at this speed.
+                repeats[currentIndex]++;
+            } else {
+                //Otherwise we need to determine what speed to go at next.
+                var nextIVal = IVals[currentIndex];
+                while (currentSpeed < requiredVelocity) {
+                    //While the current speed is too slow, calculate the next available speed
+                    nextIVal--; //Next speed is at the next IVal.
+                    currentSpeed = (stepPerSec / nextIVal); //Convert to a speed
+                }
+                currentIndex++; //New speed means a new index
+                IVals[currentIndex] = nextIVal; //store the new IVal
+                repeats[currentIndex] = 1; //And start off with 1 step of it.
+            }
+            if (IVals[currentIndex] == stopIVal) {
+                //If we have hit the stopping speed, then the table is complete.
+                //Pad the table with copies of the last element until it is the full length
+                for (var i = currentIndex + 1; i < ACCEL_TABLE_LEN; i++) {
+                    IVals[i] = IVals[i-1];
+                    repeats[i] = repeats[i-1];
+                }
+                //Increase the first few repeat counts to reduce jerk.
+                repeats[0] = repeats[0] + 2;
+                repeats[1] = repeats[1] + 1;
+                return {speeds: IVals, repeats: repeats};
+            }
+        }
+
+        //If we reach here, we failed to find a table.
+        if (accelTime > 0.85) {
+            //Otherwise try accelerating faster
+            accelTime -= 0.1;
+        } else {
+            //So lets try again with a slightly slower top speed if we haven't slowed it down too far already
+            stopIVal++;
+            //And reset accel time for next time.
+            accelTime = 4.0;
+        }
+    }
+    return null; //Failed to find a table.
+}
+
+/*
+ * Preset Generation
+ */
+
+function parseConf(name, text) {
+    //Defaults match those the config utility assumes for older .conf files.
+    var conf = {
+        name: name,
+        a: [0,0], b: [0,0], s: [0,0], n: [0,0], c: [0,0], d: [0,4], z: [0,0],
+        q: [0,0], r: DEFAULT_ST4_RATE
+    };
+    var lines = text.split(/\r?\n/);
+    for (var i = 0; i < lines.length; i++) {
+        var line = lines[i].replace(/^\s+|\s+$/g, "");
+        if ((line.length < 4) || (line.charAt(0) != ':')) {
+            continue;
+        }
+        var key = line.charAt(1);
+        var axis = (line.charAt(2) == '1') ? 0 : 1;
+        var value = line.substring(3).replace(',', '.');
+        if (key == 'r') {
+            conf.r = parseFloat(value);
+        } else if (conf[key] instanceof Array) {
+            conf[key][axis] = parseFloat(value); //:V, :U and :W are only used by the config utility to calculate the above.
+        }
+    }
+    return conf;
+}
+
+function buildPreset(conf, tables) {
+    var preset = {name: conf.name, table: [0,0], gotoSpeed: [0,0]};
+    var disableGearChange = conf.q[1] ? 1 : 0;
+    for (var axis = 0; axis < 2; axis++) {
+        if (!conf.a[axis] || !conf.b[axis] || !conf.s[axis] || !conf.n[axis]) {
+            fail(conf.name + ": missing axis configuration.");
+        }
+        //:z in a .conf file is the goto multiplier exactly as it is stored in EEPROM (the config utility converts it to a factor for display).
+        if ((conf.z[axis] < 1) || (conf.z[axis] > 255) || (conf.z[axis] != Math.floor(conf.z[axis]))) {
+            fail(conf.name + ": invalid goto multiplier.");
+        }
+        preset.gotoSpeed[axis] = conf.z[axis];
+        var table = generateAccelerationTable(conf.n[axis], conf.b[axis]);
+        if (table === null) {
+            fail(conf.name + ": failed to calculate acceleration table.");
+        }
+        //Many mounts use the same table for both axes, so only store each distinct table once.
+        var entries = [];
+        for (var i = 0; i < ACCEL_TABLE_LEN; i++) {
+            entries.push("{" + table.speeds[i] + "," + table.repeats[i] + "}");
+        }
+        var key = entries.join(",");
+        var index = -1;
+        for (var j = 0; j < tables.length; j++) {
+            if (tables[j].key == key) {
+                index = j;
+                break;
+            }
+        }
+        if (index < 0) {
+            index = tables.length;
+            tables.push({key: key, entries: entries, table: table, name: conf.name + (axis ? " DEC" : " RA")});
+        }
+        preset.table[axis] = index;
+    }
+    var st4Rate = Math.min(Math.max(conf.r, 0.05), 0.95);
+    preset.st4SpeedFactor = javaRound(st4Rate * 20);
+    preset.conf = conf;
+    preset.disableGearChange = disableGearChange;
+    return preset;
+}
+
+function utilityStoredConfig(conf) {
+    //What the config utility sends to the board when this .conf file is loaded and then stored. Loading converts the goto
+    //multiplier to a factor for the goto speed field, and storing converts the factor back to a multiplier.
+    var microstepping = !conf.q[1] && (conf.d[1] >= 8);
+    var stored = {
+        aVal: [], bVal: [], sVal: [], siderealIVal: [], normalGotoSpeed: [], encodeDirection: [], accelTable: [],
+        driverVersion: conf.d[0],
+        microstepConf: conf.d[1],
+        disableGearChange: conf.q[1] ? 1 : 0,
+        allowAdvancedHCDetection: conf.q[0] ? 1 : 0,
+        st4SpeedFactor: javaRound(Math.min(Math.max(conf.r, 0.05), 0.95) * 20)
+    };
+    for (var axis = 0; axis < 2; axis++) {
+        var minIVal = calculateMinimumIVal(conf.a[axis]);
+        var factor = calculateGotoFactor(conf.n[axis], conf.z[axis], microstepping, minIVal);
+        stored.aVal[axis] = conf.a[axis];
+        stored.bVal[axis] = conf.b[axis];
+        stored.sVal[axis] = conf.s[axis];
+        stored.siderealIVal[axis] = conf.n[axis];
+        stored.normalGotoSpeed[axis] = (factor === null) ? null : calculateGotoMultiplier(conf.n[axis], factor, microstepping, minIVal);
+        stored.encodeDirection[axis] = conf.c[axis] ? 1 : 0;
+        stored.accelTable[axis] = generateAccelerationTable(conf.n[axis], conf.b[axis]);
+    }
+    return stored;
+}
+
+function verifyPreset(preset, tables) {
+    //Compare the preset field-by-field against what the config utility would store, so the two can't silently diverge.
+    var c = preset.conf;
+    var stored = utilityStoredConfig(c);
+    var generated = {
+        aVal: c.a, bVal: c.b, sVal: c.s, siderealIVal: c.n, normalGotoSpeed: preset.gotoSpeed,
+        encodeDirection: [c.c[0] ? 1 : 0, c.c[1] ? 1 : 0],
+        accelTable: [tables[preset.table[0]].table, tables[preset.table[1]].table],
+        driverVersion: c.d[0],
+        microstepConf: c.d[1],
+        disableGearChange: preset.disableGearChange,
+        allowAdvancedHCDetection: c.q[0] ? 1 : 0,
+        st4SpeedFactor: preset.st4SpeedFactor
+    };
+    for (var field in stored) {
+        if (!(stored[field] instanceof Array)) {
+            if (stored[field] !== generated[field]) {
+                fail(preset.name + ": " + field + " is " + generated[field] + " but the config utility would store " + stored[field] + ".");
+            }
+            continue;
+        }
+        for (var axis = 0; axis < 2; axis++) {
+            var expected = stored[field][axis];
+            var actual = generated[field][axis];
+            if (field == "accelTable") {
+                if (expected === null) {
+                    fail(preset.name + ": the config utility would fail to calculate an acceleration table.");
+                }
+                for (var i = 0; i < ACCEL_TABLE_LEN; i++) {
+                    if ((actual.speeds[i] !== expected.speeds[i]) || (actual.repeats[i] !== expected.repeats[i])) {
+                        fail(preset.name + ": accelTable[" + axis + "][" + i + "] does not match the config utility.");
+                    }
+                }
+            } else if (actual !== expected) {
+                fail(preset.name + ": " + field + "[" + axis + "] is " + actual + " but the config utility would store " + expected + ".");
+            }
+        }
+    }
+}
+
+function main() {
+    var args = getArgs();
+    if (args.length < 2) {
+        fail("usage: GenerateMountPresets.js <mounts directory> <output file>");
+    }
+    var files = listConfFiles(args[0]);
+    var tables = [];
+    var presets = [];
+    for (var i = 0; i < files.length; i++) {
+        var name = files[i].replace(/\.conf$/i, "");
+        presets.push(buildPreset(parseConf(name, readFile(args[0] + "/" + files[i])), tables));
+        verifyPreset(presets[i], tables);
+    }
+    if (presets.length > 255) {
+        fail("too many presets.");
+    }
+
+    var out = [];
+    out.push("//Mount presets for the :V command.");
+    out.push("//");
+    out.push("//This file is generated from AstroEQ-ConfigUtility/mounts/*.conf by GenerateMountPresets.js");
+    out.push("//as a pre-build step. Do not edit it by hand - add or change a .conf file instead.");
+    out.push("");
+    out.push("#ifndef __MOUNT_PRESETS_H__");
+    out.push("#define __MOUNT_PRESETS_H__");
+    out.push("");
+    out.push("#include \"AstroEQ.h\"");
+    out.push("");
+    out.push("#define MountPresetCount " + presets.length);
+    out.push("");
+    out.push("static const AccelTableStruct mountPresetAccelTable[" + tables.length + "][AccelTableLength] PROGMEM = {");
+    for (var t = 0; t < tables.length; t++) {
+        out.push("    { //" + t + ": " + tables[t].name);
+        for (var e = 0; e < ACCEL_TABLE_LEN; e += 8) {
+            out.push("        " + tables[t].entries.slice(e, e + 8).join(",") + ((e + 8 < ACCEL_TABLE_LEN) ? "," : ""));
+        }
+        out.push("    }" + ((t + 1 < tables.length) ? "," : ""));
+    }
+    out.push("};");
+    out.push("");
+    out.push("static const MountPresetStruct mountPreset[MountPresetCount] PROGMEM = {");
+    for (var p = 0; p < presets.length; p++) {
+        var c = presets[p].conf;
+        out.push("    { //" + p + ": " + presets[p].name);
+        out.push("        {" + c.a[0] + "," + c.a[1] + "}, //aVal");
+        out.push("        {" + c.b[0] + "," + c.b[1] + "}, //bVal");
+        out.push("        {" + c.s[0] + "," + c.s[1] + "}, //sVal");
+        out.push("        {" + c.n[0] + "," + c.n[1] + "}, //siderealIVal");
+        out.push("        {" + presets[p].gotoSpeed[0] + "," + presets[p].gotoSpeed[1] + "}, //normalGotoSpeed");
+        out.push("        {" + (c.c[0] ? 1 : 0) + "," + (c.c[1] ? 1 : 0) + "}, //encodeDirection");
+        out.push("        {" + presets[p].table[0] + "," + presets[p].table[1] + "}, //accelTable");
+        out.push("        " + c.d[0] + ", //driverVersion");
+        out.push("        " + c.d[1] + ", //microstepConf");
+        out.push("        " + presets[p].disableGearChange + ", //disableGearChange");
+        out.push("        " + (c.q[0] ? 1 : 0) + ", //allowAdvancedHCDetection");
+        out.push("        " + presets[p].st4SpeedFactor + "  //st4SpeedFactor");
+        out.push("    }" + ((p + 1 < presets.length) ? "," : ""));
+    }
+    out.push("};");
+    out.push("");
+    out.push("#endif //__MOUNT_PRESETS_H__");
+    out.push("");
+
+    writeFile(args[1], out.join("\n"));
+    log("GenerateMountPresets: " + presets.length + " presets, " + tables.length + " acceleration tables.");
+}
+
+main();
@@ -0,0 +1,197 @@
+//Mount presets for the :V command.
+//
+//This file is generated from AstroEQ-ConfigUtility/mounts/*.conf by GenerateMountPresets.js
+//as a pre-build step. Do not edit it by hand - add or change a .conf file instead.
+
+#ifndef __MOUNT_PRESETS_H__
+#define __MOUNT_PRESETS_H__
+
+#include "AstroEQ.h"
+
+#define MountPresetCount 7
+
+static const AccelTableStruct mountPresetAccelTable[8][AccelTableLength] PROGMEM = {
+    { //0: EQ3-2-Skywatcher-Type1 RA
+        {212,3},{89,2},{71,1},{62,1},{55,1},{50,1},{47,1},{44,1},
+        {41,1},{39,1},{37,1},{36,1},{34,1},{33,1},{32,1},{31,1},
+        {30,1},{29,2},{28,1},{27,2},{26,1},{25,2},{24,3},{23,2},
+        {22,3},{21,3},{20,4},{19,5},{18,5},{17,6},{16,8},{15,9},
+        {14,11},{13,14},{12,17},{11,23},{10,30},{9,40},{8,57},{7,83},
+        {6,85},{6,45},{5,85},{5,85},{5,48},{4,85},{4,85},{4,85},
+        {4,85},{4,69},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,85},{3,59},{2,1},{2,1},{2,1}
+    },
+    { //1: EQ3-2-Skywatcher-Type1 DEC
+        {347,3},{73,2},{63,1},{56,1},{51,1},{47,1},{44,1},{41,1},
+        {39,1},{37,1},{36,1},{34,1},{33,1},{32,1},{31,1},{30,1},
+        {29,2},{28,1},{27,1},{26,2},{25,2},{24,2},{23,3},{22,3},
+        {21,3},{20,4},{19,5},{18,5},{17,6},{16,7},{15,9},{14,11},
+        {13,14},{12,17},{11,23},{10,29},{9,40},{8,56},{7,83},{6,85},
+        {6,43},{5,85},{5,85},{5,46},{4,85},{4,85},{4,85},{4,85},
+        {4,65},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,50},{2,1},{2,1},{2,1},{2,1}
+    },
+    { //2: EQ3-2-Skywatcher-Type2 DEC
+        {403,3},{68,2},{60,1},{54,1},{50,1},{46,1},{43,1},{41,1},
+        {39,1},{37,1},{36,1},{34,1},{33,1},{32,1},{31,1},{30,1},
+        {29,2},{28,1},{27,2},{26,2},{25,2},{24,2},{23,2},{22,3},
+        {21,4},{20,4},{19,4},{18,6},{17,6},{16,8},{15,9},{14,12},
+        {13,14},{12,17},{11,23},{10,31},{9,41},{8,58},{7,85},{6,85},
+        {6,48},{5,85},{5,85},{5,53},{4,85},{4,85},{4,85},{4,85},
+        {4,78},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,79},{2,1},{2,1},{2,1},{2,1}
+    },
+    { //3: EQ3-2-Synscan-Motors RA
+        {260,3},{85,2},{70,1},{60,1},{54,1},{50,1},{46,1},{43,1},
+        {41,1},{39,1},{37,1},{36,1},{34,1},{33,1},{32,1},{31,1},
+        {30,1},{29,2},{28,1},{27,2},{26,1},{25,2},{24,3},{23,2},
+        {22,3},{21,4},{20,4},{19,4},{18,5},{17,7},{16,7},{15,9},
+        {14,12},{13,14},{12,17},{11,23},{10,30},{9,41},{8,57},{7,84},
+        {6,85},{6,46},{5,85},{5,85},{5,50},{4,85},{4,85},{4,85},
+        {4,85},{4,73},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,85},{3,68},{2,1},{2,1},{2,1}
+    },
+    { //4: EQ3-2-Synscan-Motors DEC
+        {183,3},{90,2},{72,1},{62,1},{55,1},{51,1},{47,1},{44,1},
+        {41,1},{39,1},{37,1},{36,1},{34,1},{33,1},{32,1},{31,1},
+        {30,1},{29,2},{28,1},{27,2},{26,1},{25,2},{24,3},{23,2},
+        {22,3},{21,3},{20,4},{19,5},{18,5},{17,6},{16,8},{15,9},
+        {14,11},{13,14},{12,17},{11,23},{10,29},{9,41},{8,56},{7,84},
+        {6,85},{6,44},{5,85},{5,85},{5,48},{4,85},{4,85},{4,85},
+        {4,85},{4,69},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,85},{3,58},{2,1},{2,1},{2,1}
+    },
+    { //5: EQ5-Custom-Pulley RA
+        {253,3},{84,2},{69,1},{60,1},{54,1},{49,1},{46,1},{43,1},
+        {40,1},{38,1},{37,1},{35,1},{34,1},{33,1},{32,1},{31,1},
+        {30,1},{29,1},{28,1},{27,2},{26,2},{25,1},{24,3},{23,2},
+        {22,3},{21,3},{20,4},{19,5},{18,5},{17,6},{16,7},{15,9},
+        {14,11},{13,13},{12,18},{11,22},{10,29},{9,39},{8,56},{7,82},
+        {6,85},{6,42},{5,85},{5,85},{5,43},{4,85},{4,85},{4,85},
+        {4,85},{4,61},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,85},{3,41},{2,1},{2,1},{2,1}
+    },
+    { //6: EQ5-Skywatcher RA
+        {193,3},{90,2},{72,1},{62,1},{56,1},{51,1},{47,1},{44,1},
+        {42,1},{39,1},{38,1},{36,1},{35,1},{33,1},{32,1},{31,1},
+        {30,1},{29,2},{28,1},{27,2},{26,2},{25,2},{24,2},{23,2},
+        {22,3},{21,4},{20,4},{19,4},{18,6},{17,6},{16,7},{15,10},
+        {14,11},{13,14},{12,17},{11,23},{10,30},{9,41},{8,57},{7,84},
+        {6,85},{6,46},{5,85},{5,85},{5,51},{4,85},{4,85},{4,85},
+        {4,85},{4,72},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,85},{3,68},{2,1},{2,1},{2,1}
+    },
+    { //7: EQ6-Synscan RA
+        {156,3},{90,2},{72,1},{62,1},{56,1},{51,1},{47,1},{44,1},
+        {41,1},{39,1},{38,1},{36,1},{35,1},{33,1},{32,1},{31,1},
+        {30,2},{29,1},{28,1},{27,2},{26,2},{25,2},{24,2},{23,3},
+        {22,2},{21,4},{20,4},{19,4},{18,6},{17,6},{16,8},{15,9},
+        {14,11},{13,14},{12,18},{11,23},{10,30},{9,41},{8,57},{7,85},
+        {6,85},{6,47},{5,85},{5,85},{5,51},{4,85},{4,85},{4,85},
+        {4,85},{4,75},{3,85},{3,85},{3,85},{3,85},{3,85},{3,85},
+        {3,85},{3,85},{3,85},{3,85},{3,72},{2,1},{2,1},{2,1}
+    }
+};
+
+static const MountPresetStruct mountPreset[MountPresetCount] PROGMEM = {
+    { //0: EQ3-2-Skywatcher-Type1
+        {2995200,998400}, //aVal
+        {14739,8053}, //bVal
+        {23040,15360}, //sVal
+        {424,695}, //siderealIVal
+        {9,15}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {0,1}, //accelTable
+        1, //driverVersion
+        4, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    },
+    { //1: EQ3-2-Skywatcher-Type2
+        {2995200,988416}, //aVal
+        {14739,9246}, //bVal
+        {23040,15206}, //sVal
+        {424,806}, //siderealIVal
+        {9,17}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {0,2}, //accelTable
+        1, //driverVersion
+        4, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    },
+    { //2: EQ3-2-Synscan-Motors
+        {2711704,1355852}, //aVal
+        {16397,5775}, //bVal
+        {20859,20859}, //sVal
+        {521,367}, //siderealIVal
+        {8,6}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {3,4}, //accelTable
+        1, //driverVersion
+        32, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    },
+    { //3: EQ5-Custom-Pulley
+        {2457601,2457601}, //aVal
+        {14461,14461}, //bVal
+        {17067,17067}, //sVal
+        {507,507}, //siderealIVal
+        {5,5}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {5,5}, //accelTable
+        1, //driverVersion
+        32, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    },
+    { //4: EQ5-Skywatcher
+        {3317760,3317760}, //aVal
+        {14863,14863}, //bVal
+        {23040,23040}, //sVal
+        {386,386}, //siderealIVal
+        {9,9}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {6,6}, //accelTable
+        1, //driverVersion
+        4, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    },
+    { //5: EQ6-Synscan
+        {4512001,4512001}, //aVal
+        {16390,16390}, //bVal
+        {25067,25067}, //sVal
+        {313,313}, //siderealIVal
+        {4,4}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {7,7}, //accelTable
+        1, //driverVersion
+        32, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    },
+    { //6: HEQ5-Syntrek
+        {4512000,4512000}, //aVal
+        {16390,16390}, //bVal
+        {33422,33422}, //sVal
+        {313,313}, //siderealIVal
+        {26,26}, //normalGotoSpeed
+        {0,0}, //encodeDirection
+        {7,7}, //accelTable
+        1, //driverVersion
+        32, //microstepConf
+        0, //disableGearChange
+        0, //allowAdvancedHCDetection
+        5  //st4SpeedFactor
+    }
+};
+
+#endif //__MOUNT_PRESETS_H__
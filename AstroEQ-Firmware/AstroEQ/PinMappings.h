@@ -159,10 +159,9 @@
 #define USART1_RX_vect USART1_RXC_vect
 #endif
 
-//Pick some registers we are not going use for GPIOR
-#define GPIOR0 PORTC
-#define GPIOR1 OCR0
-#define GPIOR2 TCNT0
+#ifndef TIMER0_COMPA_vect
+#define TIMER0_COMPA_vect TIMER0_COMP_vect
+#endif
 
 #define PCICR GICR
 
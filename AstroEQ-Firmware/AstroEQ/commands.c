@@ -59,6 +59,8 @@ void Commands_init(unsigned long _eVal, byte _gVal){
     Commands_configureST4Speed(CMD_ST4_DEFAULT);
 }
 
+const byte guideRateFactors[5] = {19,15,10,5,2}; //st4SpeedFactor for each :P rate. 0 = 1x (limited to 0.95x), 1 = 0.75x, 2 = 0.5x, 3 = 0.25x, 4 = 0.125x (rounded to 0.1x)
+
 void Commands_configureST4Speed(byte mode) {
     cmd.st4Mode = mode;
     if (mode == CMD_ST4_HIGHSPEED) {
@@ -96,9 +98,13 @@ const char cmd_commands[numberOfCommands][3] = { {'j', 0, 6}, //arranged in orde
                                                  {'g', 0, 2},
                                                  {'s', 0, 6},
                                                  {'E', 6, 0},
-                                                 {'P', 1, 0},
+                                                 {'P', 1, 0}, //guide rate is common to both axes: set by :P1, :P2 must match
                                                  {'F', 0, 0},
                                                  {'L', 0, 0},
+                                                 //Extended Commands
+                                                 {'U', 6, 0},
+                                                 {'u', 0, 2},
+                                                 {'W', 6, 0},
                                                  //Programmer Commands
                                                  {'A', 6, 0},
                                                  {'B', 6, 0},
@@ -119,6 +125,10 @@ const char cmd_commands[numberOfCommands][3] = { {'j', 0, 6}, //arranged in orde
                                                  {'X', 6, 0},
                                                  {'x', 0, 6},
                                                  {'Y', 2, 0},
+                                                 {'v', 0, 6},
+#ifdef MOUNT_PRESETS
+                                                 {'V', 2, 0},
+#endif
                                                  {'T', 0, 0}
                                                };
 
@@ -64,7 +64,12 @@ typedef struct{
     AccelTableStruct accelTable     [2][AccelTableLength]; //Acceleration profile now controlled via lookup table. The first element will be used for cmd.minSpeed[]. max repeat=85
 } Commands;
 
-#define numberOfCommands 37
+#ifdef MOUNT_PRESETS
+#define numberOfPresetCommands 1
+#else
+#define numberOfPresetCommands 0
+#endif
+#define numberOfCommands (41 + numberOfPresetCommands)
 
 void Commands_init(unsigned long _eVal, byte _gVal);
 void Commands_configureST4Speed(byte mode);
@@ -73,6 +78,7 @@ char Commands_getLength(char cmd, bool sendRecieve);
 //Command definitions
 extern const char command[numberOfCommands][3];
 extern Commands cmd;
+extern const byte guideRateFactors[5];
 
 //Methods for accessing command variables
 inline void cmd_setDir(byte target, bool _dir){ //Set Method
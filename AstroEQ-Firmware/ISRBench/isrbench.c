@@ -0,0 +1,619 @@
+/*
+  AstroEQ ISR Timing Bench
+
+  Runs a firmware .elf in simavr against a scripted scenario, and measures for every interrupt vector:
+    - Number of times it ran (count) - informational
+    - Worst case and mean cycles from entry to reti, including anything which nested inside it (max_cycles, mean_cycles)
+    - Worst case cycles from the flag being raised to the ISR being entered (max_latency)
+    - Number of times the flag was raised again before the ISR returned (overruns)
+
+  For each step pin it also measures:
+    - Number of step pin edges made by the step timer ISR (edges) - informational
+    - Worst case cycles from the timer compare match to the pin changing, and the spread of that delay (delay_max, jitter)
+    - If the scenario gives an ideal step rate, the worst case error of each step against the ideal (error_cycles)
+
+  As the simulator counts cycles in 64bit, none of the measurements wrap however long an ISR runs for.
+
+  Usage:
+    isrbench <mcu> <firmware.elf> <scenario> [-b baseline] [-u baseline] [-t tolerance%]
+
+  With -b, every metric (other than the informational ones) must be no more than the baseline value plus the tolerance,
+  otherwise the bench exits with 1. With -u, the baseline file is (re)written with the results. If the scenario fails,
+  the bench exits with 2.
+
+  Scenario commands (one per line, '#' starts a comment):
+    run <ms>              - run the firmware for <ms> milliseconds
+    send <command>        - send a command (e.g. ":F3") and wait for the reply. An error reply fails the scenario
+    reset                 - reset the MCU, keeping the contents of the EEPROM
+    measure               - clear all measurements so far
+    rate <RA|DC> <steps/s>- ideal step rate to measure the step timing error against
+    expect <RA|DC>        - the axis must make steps after this point, otherwise the scenario fails
+    poll <ms> <cmd> ...   - for <ms> milliseconds, send the commands one after another as fast as replies come back
+    include <file>        - run the commands in another file, relative to this one (e.g. a shared mount setup)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "sim_interrupts.h"
+#include "avr_ioport.h"
+#include "avr_uart.h"
+#include "avr_eeprom.h"
+
+#include "sim_mega162.h"
+
+#define F_CPU 16000000UL
+#define CYCLES_PER_MS (F_CPU / 1000)
+#define REPLY_TIMEOUT (5000 * CYCLES_PER_MS) //Synta replies should be well within this.
+
+#define RA 0
+#define DC 1
+
+#define MAX_VECTORS 64
+#define MAX_REPLY 32
+#define MAX_LINE 256
+#define MAX_METRICS 256
+
+#define EXIT_REGRESSION 1
+#define EXIT_SCENARIO   2
+
+/*
+ * MCU Descriptions
+ */
+
+static const char* const mega162Vectors[] = {
+    "RESET", "INT0", "INT1", "INT2", "PCINT0", "PCINT1", "TIMER3_CAPT", "TIMER3_COMPA", "TIMER3_COMPB", "TIMER3_OVF",
+    "TIMER2_COMP", "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA", "TIMER1_COMPB", "TIMER1_OVF", "TIMER0_COMP", "TIMER0_OVF",
+    "SPI_STC", "USART0_RXC", "USART1_RXC", "USART0_UDRE", "USART1_UDRE", "USART0_TXC", "USART1_TXC", "EE_RDY", "ANA_COMP",
+    "SPM_RDY"
+};
+
+static const char* const mega2560Vectors[] = {
+    "RESET", "INT0", "INT1", "INT2", "INT3", "INT4", "INT5", "INT6", "INT7", "PCINT0", "PCINT1", "PCINT2", "WDT",
+    "TIMER2_COMPA", "TIMER2_COMPB", "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA", "TIMER1_COMPB", "TIMER1_COMPC",
+    "TIMER1_OVF", "TIMER0_COMPA", "TIMER0_COMPB", "TIMER0_OVF", "SPI_STC", "USART0_RX", "USART0_UDRE", "USART0_TX",
+    "ANALOG_COMP", "ADC", "EE_READY", "TIMER3_CAPT", "TIMER3_COMPA", "TIMER3_COMPB", "TIMER3_COMPC", "TIMER3_OVF"
+};
+
+typedef struct {
+    const char* name;
+    avr_t* (*make)(void); //NULL if simavr has its own core
+    uint8_t stepVector[2]; //Step timer vectors, RA and DC
+    char stepPort[2];
+    uint8_t stepBit[2];
+    uint16_t eepromSize;
+    const char* const* vectorNames;
+    uint8_t vectorNameCount;
+} McuInfo;
+
+static const McuInfo mcus[] = {
+    //Step pins are Arduino pins 5 and 30 on the ATMega162, and 5 and 12 on the ATMega2560. See PinMappings.h.
+    { "atmega162",  mega162_make, {12, 6},  {'D','E'}, {4, 2}, 512,  mega162Vectors,  sizeof(mega162Vectors)/sizeof(mega162Vectors[0]) },
+    { "atmega2560", NULL,         {16, 31}, {'E','B'}, {3, 6}, 4096, mega2560Vectors, sizeof(mega2560Vectors)/sizeof(mega2560Vectors[0]) },
+};
+
+static const char axisName[2][3] = {"RA","DC"};
+
+/*
+ * Measurements
+ */
+
+typedef struct {
+    avr_cycle_count_t pendingCycle; //When the flag was last raised
+    avr_cycle_count_t servicedCycle; //When the flag being serviced was raised
+    avr_cycle_count_t entryCycle;
+    bool running;
+    //Statistics
+    unsigned long count;
+    avr_cycle_count_t totalCycles;
+    avr_cycle_count_t maxCycles;
+    avr_cycle_count_t maxLatency;
+    unsigned long overruns;
+} VectorStats;
+
+typedef struct {
+    int lastValue;
+    bool expected;
+    double rate; //Ideal steps/s. 0 if not measuring the error.
+    //Statistics
+    unsigned long edges;
+    unsigned long steps;
+    avr_cycle_count_t firstStep;
+    avr_cycle_count_t delayMin;
+    avr_cycle_count_t delayMax;
+    double errorMax;
+} StepStats;
+
+typedef struct {
+    char buffer[MAX_REPLY];
+    unsigned int length;
+    bool complete;
+    //Statistics
+    unsigned long replies;
+    avr_cycle_count_t maxReplyCycles;
+} ReplyStats;
+
+static const McuInfo* mcu;
+static avr_t* avr;
+static avr_irq_t* uartInput;
+static VectorStats vectors[MAX_VECTORS];
+static StepStats steps[2];
+static ReplyStats reply;
+
+static void clearMeasurements(void) {
+    for (int v = 0; v < MAX_VECTORS; v++) {
+        vectors[v].count = 0;
+        vectors[v].totalCycles = 0;
+        vectors[v].maxCycles = 0;
+        vectors[v].maxLatency = 0;
+        vectors[v].overruns = 0;
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        steps[axis].edges = 0;
+        steps[axis].steps = 0;
+        steps[axis].delayMin = 0;
+        steps[axis].delayMax = 0;
+        steps[axis].errorMax = 0;
+    }
+    reply.replies = 0;
+    reply.maxReplyCycles = 0;
+}
+
+static void vectorPendingHook(struct avr_irq_t* irq, uint32_t value, void* param) {
+    VectorStats* stats = (VectorStats*)param;
+    if (!value) {
+        return; //Flag cleared
+    }
+    if (stats->running) {
+        stats->overruns++; //The next period has started before the last one was handled.
+    }
+    stats->pendingCycle = avr->cycle;
+}
+
+static void vectorRunningHook(struct avr_irq_t* irq, uint32_t value, void* param) {
+    VectorStats* stats = (VectorStats*)param;
+    if (value) {
+        stats->running = true;
+        stats->entryCycle = avr->cycle;
+        stats->servicedCycle = stats->pendingCycle;
+        avr_cycle_count_t latency = avr->cycle - stats->pendingCycle;
+        if (latency > stats->maxLatency) {
+            stats->maxLatency = latency;
+        }
+    } else if (stats->running) {
+        stats->running = false;
+        avr_cycle_count_t cycles = avr->cycle - stats->entryCycle;
+        stats->count++;
+        stats->totalCycles += cycles;
+        if (cycles > stats->maxCycles) {
+            stats->maxCycles = cycles;
+        }
+    }
+}
+
+static void stepPinHook(struct avr_irq_t* irq, uint32_t value, void* param) {
+    int axis = (int)(intptr_t)param;
+    StepStats* stats = &steps[axis];
+    VectorStats* timer = &vectors[mcu->stepVector[axis]];
+    int pinValue = !!value;
+    if (pinValue == stats->lastValue) {
+        return; //The port was written, but the pin didn't change.
+    }
+    stats->lastValue = pinValue;
+    if (!timer->running) {
+        return; //Only the step timer makes steps, anything else is initialisation or stopping.
+    }
+
+    avr_cycle_count_t delay = avr->cycle - timer->servicedCycle;
+    if (!stats->edges || (delay < stats->delayMin)) {
+        stats->delayMin = delay;
+    }
+    if (delay > stats->delayMax) {
+        stats->delayMax = delay;
+    }
+    stats->edges++;
+
+    if (pinValue) {
+        //Rising edge is the start of a step.
+        if (!stats->steps) {
+            stats->firstStep = avr->cycle;
+        } else if (stats->rate > 0) {
+            double ideal = (double)stats->firstStep + (double)stats->steps * ((double)F_CPU / stats->rate);
+            double error = fabs((double)avr->cycle - ideal);
+            if (error > stats->errorMax) {
+                stats->errorMax = error;
+            }
+        }
+        stats->steps++;
+    }
+}
+
+static void uartOutputHook(struct avr_irq_t* irq, uint32_t value, void* param) {
+    if (reply.complete) {
+        return; //Nobody waiting for a reply.
+    }
+    if (reply.length < (MAX_REPLY - 1)) {
+        reply.buffer[reply.length++] = (char)value;
+        reply.buffer[reply.length] = '\0';
+    }
+    if ((char)value == '\r') {
+        reply.complete = true;
+    }
+}
+
+/*
+ * Simulation
+ */
+
+static bool runUntil(avr_cycle_count_t end, bool untilReply) {
+    while (avr->cycle < end) {
+        if (untilReply && reply.complete) {
+            return true;
+        }
+        int state = avr_run(avr);
+        if ((state == cpu_Done) || (state == cpu_Crashed)) {
+            fprintf(stderr, "Firmware stopped (state %d) at cycle %llu\n", state, (unsigned long long)avr->cycle);
+            return false;
+        }
+    }
+    return !untilReply || reply.complete;
+}
+
+static bool runFor(double ms) {
+    return runUntil(avr->cycle + (avr_cycle_count_t)(ms * CYCLES_PER_MS), false);
+}
+
+static bool sendCommand(const char* command, bool quiet) {
+    avr_cycle_count_t start = avr->cycle;
+    reply.length = 0;
+    reply.buffer[0] = '\0';
+    reply.complete = false;
+    for (const char* c = command; *c; c++) {
+        avr_raise_irq(uartInput, (uint8_t)*c);
+    }
+    avr_raise_irq(uartInput, '\r');
+
+    bool replied = runUntil(start + REPLY_TIMEOUT, true);
+    reply.complete = true;
+    if (!replied) {
+        fprintf(stderr, "No reply to %s\n", command);
+        return false;
+    }
+    avr_cycle_count_t cycles = avr->cycle - start;
+    reply.replies++;
+    if (cycles > reply.maxReplyCycles) {
+        reply.maxReplyCycles = cycles;
+    }
+    reply.buffer[strcspn(reply.buffer, "\r")] = '\0';
+    if (!quiet) {
+        printf("# %s -> %s\n", command, reply.buffer);
+    }
+    if (reply.buffer[0] != '=') {
+        fprintf(stderr, "Error reply to %s: %s\n", command, reply.buffer);
+        return false;
+    }
+    return true;
+}
+
+static void resetMCU(void) {
+    //simavr's reset is a power-on reset, so keep hold of what the firmware stored in EEPROM.
+    uint8_t eeprom[4096];
+    avr_eeprom_desc_t desc = { .ee = eeprom, .offset = 0, .size = mcu->eepromSize };
+    avr_ioctl(avr, AVR_IOCTL_EEPROM_GET, &desc);
+    avr_reset(avr);
+    desc.ee = eeprom;
+    avr_ioctl(avr, AVR_IOCTL_EEPROM_SET, &desc);
+    for (int v = 0; v < MAX_VECTORS; v++) {
+        vectors[v].running = false;
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        steps[axis].lastValue = 0;
+    }
+}
+
+static bool setupMCU(const char* mcuName, const char* firmwarePath) {
+    for (unsigned int i = 0; i < sizeof(mcus)/sizeof(mcus[0]); i++) {
+        if (!strcmp(mcus[i].name, mcuName)) {
+            mcu = &mcus[i];
+        }
+    }
+    if (!mcu) {
+        fprintf(stderr, "Unsupported MCU: %s\n", mcuName);
+        return false;
+    }
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(firmwarePath, &firmware)) {
+        fprintf(stderr, "Unable to read %s\n", firmwarePath);
+        return false;
+    }
+    strncpy(firmware.mmcu, mcu->name, sizeof(firmware.mmcu) - 1);
+    firmware.frequency = F_CPU;
+
+    avr = mcu->make ? mcu->make() : avr_make_mcu_by_name(mcu->name);
+    if (!avr) {
+        fprintf(stderr, "simavr has no core for %s\n", mcu->name);
+        return false;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = F_CPU;
+
+    //Hook every vector the core implements.
+    for (int v = 1; v < MAX_VECTORS; v++) {
+        avr_irq_t* irq = avr_get_interrupt_irq(avr, v);
+        if (irq) {
+            avr_irq_register_notify(irq + AVR_INT_IRQ_PENDING, vectorPendingHook, &vectors[v]);
+            avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, vectorRunningHook, &vectors[v]);
+        }
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        avr_irq_t* pin = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(mcu->stepPort[axis]), mcu->stepBit[axis]);
+        avr_irq_register_notify(pin, stepPinHook, (void*)(intptr_t)axis);
+    }
+
+    //The serial port. Replies are collected here rather than printed by simavr.
+    uint32_t flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+    uartInput = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), uartOutputHook, NULL);
+    reply.complete = true;
+
+    return true;
+}
+
+/*
+ * Scenario
+ */
+
+static int axisFromName(const char* name) {
+    if (name && !strcmp(name, "RA")) {
+        return RA;
+    }
+    if (name && !strcmp(name, "DC")) {
+        return DC;
+    }
+    return -1;
+}
+
+static bool runScenario(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return false;
+    }
+
+    char line[MAX_LINE];
+    unsigned int lineNumber = 0;
+    bool success = true;
+    while (success && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        char* keyword = strtok(line, " \t");
+        if (!keyword) {
+            continue; //Blank line
+        }
+        char* argument = strtok(NULL, " \t");
+
+        if (!strcmp(keyword, "run") && argument) {
+            success = runFor(atof(argument));
+        } else if (!strcmp(keyword, "send") && argument) {
+            success = sendCommand(argument, false);
+        } else if (!strcmp(keyword, "reset")) {
+            resetMCU();
+        } else if (!strcmp(keyword, "measure")) {
+            clearMeasurements();
+        } else if (!strcmp(keyword, "rate") && (axisFromName(argument) >= 0)) {
+            char* rate = strtok(NULL, " \t");
+            steps[axisFromName(argument)].rate = rate ? atof(rate) : 0;
+            steps[axisFromName(argument)].expected = true;
+        } else if (!strcmp(keyword, "expect") && (axisFromName(argument) >= 0)) {
+            steps[axisFromName(argument)].expected = true;
+        } else if (!strcmp(keyword, "poll") && argument) {
+            char* commands[16];
+            unsigned int commandCount = 0;
+            char* command;
+            while ((commandCount < 16) && (command = strtok(NULL, " \t"))) {
+                commands[commandCount++] = command;
+            }
+            avr_cycle_count_t end = avr->cycle + (avr_cycle_count_t)(atof(argument) * CYCLES_PER_MS);
+            for (unsigned int i = 0; success && commandCount && (avr->cycle < end); i = (i + 1) % commandCount) {
+                success = sendCommand(commands[i], true);
+            }
+        } else if (!strcmp(keyword, "include") && argument) {
+            char includePath[MAX_LINE];
+            const char* slash = strrchr(path, '/');
+            int directoryLength = slash ? (int)(slash - path + 1) : 0;
+            snprintf(includePath, sizeof(includePath), "%.*s%s", directoryLength, path, argument);
+            success = runScenario(includePath);
+        } else {
+            fprintf(stderr, "%s:%u: unknown or incomplete command '%s'\n", path, lineNumber, keyword);
+            success = false;
+        }
+    }
+    fclose(file);
+    return success;
+}
+
+static bool checkExpectedSteps(void) {
+    bool success = true;
+    for (int axis = 0; axis < 2; axis++) {
+        if (steps[axis].expected && !steps[axis].steps) {
+            //If this happens on a firmware which works on hardware, check that the simavr version sets ICFn at TOP in
+            //CTC mode with ICRn as TOP (WGM 12), as that is what drives the step timers.
+            fprintf(stderr, "%s axis was commanded to move but the step timer made no steps\n", axisName[axis]);
+            success = false;
+        }
+    }
+    return success;
+}
+
+/*
+ * Results
+ */
+
+typedef struct {
+    char key[48];
+    double value;
+    bool info; //Informational only, not checked against the baseline
+} Metric;
+
+static Metric metrics[MAX_METRICS];
+static unsigned int metricCount = 0;
+
+static void addMetric(const char* prefix, const char* name, double value, bool info) {
+    if (metricCount < MAX_METRICS) {
+        snprintf(metrics[metricCount].key, sizeof(metrics[metricCount].key), "%s.%s", prefix, name);
+        metrics[metricCount].value = round(value);
+        metrics[metricCount].info = info;
+        metricCount++;
+    }
+}
+
+static void collectMetrics(void) {
+    char prefix[32];
+    for (int v = 1; v < MAX_VECTORS; v++) {
+        VectorStats* stats = &vectors[v];
+        if (!stats->count) {
+            continue;
+        }
+        if (v < mcu->vectorNameCount) {
+            snprintf(prefix, sizeof(prefix), "%s", mcu->vectorNames[v]);
+        } else {
+            snprintf(prefix, sizeof(prefix), "vector%d", v);
+        }
+        addMetric(prefix, "count",       stats->count, true);
+        addMetric(prefix, "max_cycles",  stats->maxCycles, false);
+        addMetric(prefix, "mean_cycles", (double)stats->totalCycles / stats->count, false);
+        addMetric(prefix, "max_latency", stats->maxLatency, false);
+        addMetric(prefix, "overruns",    stats->overruns, false);
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        StepStats* stats = &steps[axis];
+        if (!stats->edges) {
+            continue;
+        }
+        snprintf(prefix, sizeof(prefix), "step.%s", axisName[axis]);
+        addMetric(prefix, "edges",     stats->edges, true);
+        addMetric(prefix, "delay_max", stats->delayMax, false);
+        addMetric(prefix, "jitter",    stats->delayMax - stats->delayMin, false);
+        if (stats->rate > 0) {
+            addMetric(prefix, "error_cycles", stats->errorMax, false);
+        }
+    }
+    if (reply.replies) {
+        addMetric("poll", "replies",          reply.replies, true);
+        addMetric("poll", "max_reply_cycles", reply.maxReplyCycles, false);
+    }
+}
+
+static bool writeBaseline(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Unable to write %s\n", path);
+        return false;
+    }
+    for (unsigned int i = 0; i < metricCount; i++) {
+        fprintf(file, "%s %.0f\n", metrics[i].key, metrics[i].value);
+    }
+    fclose(file);
+    return true;
+}
+
+static bool checkBaseline(const char* path, double tolerance) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "No baseline %s - record one with -u\n", path);
+        return false;
+    }
+
+    bool checked[MAX_METRICS] = {false};
+    bool pass = true;
+    char line[MAX_LINE];
+    while (fgets(line, sizeof(line), file)) {
+        char key[48];
+        double baseline;
+        if (sscanf(line, "%47s %lf", key, &baseline) != 2) {
+            continue;
+        }
+        unsigned int i;
+        for (i = 0; (i < metricCount) && strcmp(metrics[i].key, key); i++);
+        if (i == metricCount) {
+            //e.g. a vector which no longer runs, or a step timer which no longer steps.
+            printf("FAIL %s missing (baseline %.0f)\n", key, baseline);
+            pass = false;
+            continue;
+        }
+        checked[i] = true;
+        if (metrics[i].info) {
+            continue;
+        }
+        double limit = baseline * (1.0 + tolerance / 100.0);
+        if (metrics[i].value > limit) {
+            printf("FAIL %s %.0f > baseline %.0f\n", key, metrics[i].value, baseline);
+            pass = false;
+        }
+    }
+    fclose(file);
+
+    for (unsigned int i = 0; i < metricCount; i++) {
+        if (!checked[i]) {
+            printf("FAIL %s not in baseline\n", metrics[i].key);
+            pass = false;
+        }
+    }
+    return pass;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <mcu> <firmware.elf> <scenario> [-b baseline] [-u baseline] [-t tolerance%%]\n", argv[0]);
+        return EXIT_SCENARIO;
+    }
+    const char* baselinePath = NULL;
+    bool update = false;
+    double tolerance = 5.0;
+    for (int i = 4; i < argc; i++) {
+        if (!strcmp(argv[i], "-b") && (i + 1 < argc)) {
+            baselinePath = argv[++i];
+        } else if (!strcmp(argv[i], "-u") && (i + 1 < argc)) {
+            baselinePath = argv[++i];
+            update = true;
+        } else if (!strcmp(argv[i], "-t") && (i + 1 < argc)) {
+            tolerance = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return EXIT_SCENARIO;
+        }
+    }
+
+    if (!setupMCU(argv[1], argv[2])) {
+        return EXIT_SCENARIO;
+    }
+    clearMeasurements();
+    if (!runScenario(argv[3]) || !checkExpectedSteps()) {
+        return EXIT_SCENARIO;
+    }
+
+    collectMetrics();
+    for (unsigned int i = 0; i < metricCount; i++) {
+        printf("%s %.0f\n", metrics[i].key, metrics[i].value);
+    }
+    if (!baselinePath) {
+        return EXIT_SUCCESS;
+    }
+    if (update) {
+        return writeBaseline(baselinePath) ? EXIT_SUCCESS : EXIT_SCENARIO;
+    }
+    return checkBaseline(baselinePath, tolerance) ? EXIT_SUCCESS : EXIT_REGRESSION;
+}
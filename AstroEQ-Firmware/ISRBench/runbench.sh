@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# AstroEQ ISR Timing Regression Bench
+#
+# Builds the firmware for the ATMega162 and ATMega2560 with the release settings, runs every scenario in simavr, and
+# compares the ISR timing against the stored baselines. Exits non-zero if anything has got slower than its baseline
+# (plus the tolerance), or if a scenario fails.
+#
+# Usage: ./runbench.sh [--update]
+#   --update  Record new baselines from this firmware instead of checking against them.
+#
+# Requires avr-gcc, avr-libc and simavr (with headers). The include paths can be overridden with SIMAVR_INCLUDE and
+# AVR_INCLUDE, and the tolerance (in %) with TOLERANCE.
+#
+
+set -e
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+FIRMWARE_DIR="$BENCH_DIR/../AstroEQ"
+BUILD_DIR="$BENCH_DIR/build"
+SIMAVR_INCLUDE=${SIMAVR_INCLUDE:-/usr/include/simavr}
+AVR_INCLUDE=${AVR_INCLUDE:-/usr/lib/avr/include}
+TOLERANCE=${TOLERANCE:-5}
+MCUS="atmega162 atmega2560"
+
+MODE=-b
+if [ "$1" = "--update" ]; then
+    MODE=-u
+fi
+
+mkdir -p "$BUILD_DIR"
+
+#Build the bench. avr-libc's headers are only used to describe the ATMega162 core, so come after the host's own.
+cc -O2 -Wall -I"$SIMAVR_INCLUDE" -idirafter "$AVR_INCLUDE" -o "$BUILD_DIR/isrbench" \
+    "$BENCH_DIR/isrbench.c" "$BENCH_DIR/sim_mega162.c" -lsimavr -lelf -lm
+
+#Build the firmware with the same settings as the release configuration of the Atmel Studio projects.
+for MCU in $MCUS; do
+    mkdir -p "$BUILD_DIR/$MCU"
+    avr-gcc -mmcu=$MCU -DNDEBUG -DF_CPU=16000000UL -O2 -std=gnu99 -funsigned-bitfields -fpack-struct \
+        -fshort-enums -ffunction-sections -fdata-sections -Wall -Wl,--gc-sections -o "$BUILD_DIR/$MCU/AstroEQ.elf" \
+        "$FIRMWARE_DIR/AstroEQ.c" "$FIRMWARE_DIR/commands.c" "$FIRMWARE_DIR/EEPROMReader.c" \
+        "$FIRMWARE_DIR/SerialLink.c" "$FIRMWARE_DIR/synta.c" -lm
+done
+
+#Run the scenarios. Keep going after a failure so that every regression is reported.
+FAILED=0
+for MCU in $MCUS; do
+    mkdir -p "$BENCH_DIR/baselines/$MCU"
+    for SCENARIO in "$BENCH_DIR"/scenarios/*.txt; do
+        NAME=$(basename "$SCENARIO" .txt)
+        echo "=== $MCU $NAME"
+        if ! "$BUILD_DIR/isrbench" $MCU "$BUILD_DIR/$MCU/AstroEQ.elf" "$SCENARIO" \
+                $MODE "$BENCH_DIR/baselines/$MCU/$NAME.txt" -t $TOLERANCE; then
+            echo "=== $MCU $NAME FAILED"
+            FAILED=1
+        fi
+    done
+done
+
+if [ $FAILED -ne 0 ]; then
+    echo "ISR timing regression bench FAILED"
+    exit 1
+fi
+echo "ISR timing regression bench passed"
@@ -0,0 +1,260 @@
+/*
+  ATmega162 core for simavr
+
+  simavr has no model of the ATmega162, so this declares one in the same way as simavr's own cores. Only the
+  peripherals the AstroEQ firmware uses are modelled: the EEPROM, the I/O ports, USART0 and timers 0, 1 and 3.
+*/
+
+#include "sim_avr.h"
+
+#define SIM_VECTOR_SIZE 4
+#define SIM_MMCU        "atmega162"
+#define SIM_CORENAME    mcu_mega162
+
+#define _AVR_IO_H_
+#define __ASSEMBLER__
+#include "avr/iom162.h"
+//instantiate the new core
+#include "sim_core_declare.h"
+#include "avr_eeprom.h"
+#include "avr_ioport.h"
+#include "avr_uart.h"
+#include "avr_timer.h"
+
+#include "sim_mega162.h"
+
+//On the ATmega162, UCSR0C shares its address with UBRR0H (selected by the URSEL bit), which simavr can't model. The
+//firmware never changes the frame format from the 8N1 reset default, so instead the frame format is read from an
+//otherwise unused extended I/O address which is preset to 8N1 on reset.
+#define UCSR0C_SHADOW 0xFF
+#define UCSR0C_RESET  (_BV(UCSZ01) | _BV(UCSZ00))
+
+static void init(struct avr_t * avr);
+static void reset(struct avr_t * avr);
+
+const struct mcu_t {
+    avr_t          core;
+    avr_eeprom_t   eeprom;
+    avr_ioport_t   porta, portb, portc, portd, porte;
+    avr_uart_t     uart0;
+    avr_timer_t    timer0, timer1, timer3;
+} mcu_mega162 = {
+    .core = {
+        .mmcu = SIM_MMCU,
+        DEFAULT_CORE(SIM_VECTOR_SIZE),
+
+        .init = init,
+        .reset = reset,
+    },
+    AVR_EEPROM_DECLARE_NOEEPM(EE_RDY_vect),
+    .porta = {
+        .name = 'A', .r_port = PORTA, .r_ddr = DDRA, .r_pin = PINA,
+    },
+    .portb = {
+        .name = 'B', .r_port = PORTB, .r_ddr = DDRB, .r_pin = PINB,
+    },
+    .portc = {
+        .name = 'C', .r_port = PORTC, .r_ddr = DDRC, .r_pin = PINC,
+    },
+    .portd = {
+        .name = 'D', .r_port = PORTD, .r_ddr = DDRD, .r_pin = PIND,
+    },
+    .porte = {
+        .name = 'E', .r_port = PORTE, .r_ddr = DDRE, .r_pin = PINE,
+    },
+    .uart0 = {
+        .name = '0',
+        .r_udr = UDR0,
+        .r_ucsra = UCSR0A,
+        .r_ucsrb = UCSR0B,
+        .r_ucsrc = UCSR0C_SHADOW,
+
+        .rxen = AVR_IO_REGBIT(UCSR0B, RXEN0),
+        .txen = AVR_IO_REGBIT(UCSR0B, TXEN0),
+        .u2x = AVR_IO_REGBIT(UCSR0A, U2X0),
+        .usbs = AVR_IO_REGBIT(UCSR0C_SHADOW, USBS0),
+        .ucsz = AVR_IO_REGBITS(UCSR0C_SHADOW, UCSZ00, 0x3),
+        .ucsz2 = AVR_IO_REGBIT(UCSR0B, UCSZ02),
+
+        .r_ubrrl = UBRR0L,
+        .r_ubrrh = UBRR0H,
+        .rxc = {
+            .enable = AVR_IO_REGBIT(UCSR0B, RXCIE0),
+            .raised = AVR_IO_REGBIT(UCSR0A, RXC0),
+            .vector = USART0_RXC_vect,
+            .raise_sticky = 1,
+        },
+        .txc = {
+            .enable = AVR_IO_REGBIT(UCSR0B, TXCIE0),
+            .raised = AVR_IO_REGBIT(UCSR0A, TXC0),
+            .vector = USART0_TXC_vect,
+        },
+        .udrc = {
+            .enable = AVR_IO_REGBIT(UCSR0B, UDRIE0),
+            .raised = AVR_IO_REGBIT(UCSR0A, UDRE0),
+            .vector = USART0_UDRE_vect,
+            .raise_sticky = 1,
+        },
+    },
+    .timer0 = {
+        .name = '0',
+        .wgm = { AVR_IO_REGBIT(TCCR0, WGM00), AVR_IO_REGBIT(TCCR0, WGM01) },
+        .wgm_op = {
+            [0] = AVR_TIMER_WGM_NORMAL8(),
+            [2] = AVR_TIMER_WGM_CTC(),
+            [3] = AVR_TIMER_WGM_FASTPWM8(),
+        },
+        .cs = { AVR_IO_REGBIT(TCCR0, CS00), AVR_IO_REGBIT(TCCR0, CS01), AVR_IO_REGBIT(TCCR0, CS02) },
+        .cs_div = { 0, 0, 3 /* 8 */, 6 /* 64 */, 8 /* 256 */, 10 /* 1024 */ },
+
+        .r_tcnt = TCNT0,
+
+        .overflow = {
+            .enable = AVR_IO_REGBIT(TIMSK, TOIE0),
+            .raised = AVR_IO_REGBIT(TIFR, TOV0),
+            .vector = TIMER0_OVF_vect,
+        },
+        .comp = {
+            [AVR_TIMER_COMPA] = {
+                .r_ocr = OCR0,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK, OCIE0),
+                    .raised = AVR_IO_REGBIT(TIFR, OCF0),
+                    .vector = TIMER0_COMP_vect,
+                },
+            },
+        },
+    },
+    .timer1 = {
+        .name = '1',
+        .wgm = { AVR_IO_REGBIT(TCCR1A, WGM10), AVR_IO_REGBIT(TCCR1A, WGM11),
+                 AVR_IO_REGBIT(TCCR1B, WGM12), AVR_IO_REGBIT(TCCR1B, WGM13) },
+        .wgm_op = {
+            [0] = AVR_TIMER_WGM_NORMAL16(),
+            [4] = AVR_TIMER_WGM_CTC(),
+            [5] = AVR_TIMER_WGM_FASTPWM8(),
+            [6] = AVR_TIMER_WGM_FASTPWM9(),
+            [7] = AVR_TIMER_WGM_FASTPWM10(),
+            [12] = AVR_TIMER_WGM_ICCTC(), //The step timers run in this mode.
+            [14] = AVR_TIMER_WGM_ICPWM(),
+            [15] = AVR_TIMER_WGM_OCPWM(),
+        },
+        .cs = { AVR_IO_REGBIT(TCCR1B, CS10), AVR_IO_REGBIT(TCCR1B, CS11), AVR_IO_REGBIT(TCCR1B, CS12) },
+        .cs_div = { 0, 0, 3 /* 8 */, 6 /* 64 */, 8 /* 256 */, 10 /* 1024 */ },
+
+        .r_tcnt = TCNT1L,
+        .r_tcnth = TCNT1H,
+        .r_icr = ICR1L,
+        .r_icrh = ICR1H,
+
+        .overflow = {
+            .enable = AVR_IO_REGBIT(TIMSK, TOIE1),
+            .raised = AVR_IO_REGBIT(TIFR, TOV1),
+            .vector = TIMER1_OVF_vect,
+        },
+        .icr = {
+            .enable = AVR_IO_REGBIT(TIMSK, TICIE1),
+            .raised = AVR_IO_REGBIT(TIFR, ICF1),
+            .vector = TIMER1_CAPT_vect,
+        },
+        .comp = {
+            [AVR_TIMER_COMPA] = {
+                .r_ocr = OCR1AL,
+                .r_ocrh = OCR1AH,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK, OCIE1A),
+                    .raised = AVR_IO_REGBIT(TIFR, OCF1A),
+                    .vector = TIMER1_COMPA_vect,
+                },
+            },
+            [AVR_TIMER_COMPB] = {
+                .r_ocr = OCR1BL,
+                .r_ocrh = OCR1BH,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(TIMSK, OCIE1B),
+                    .raised = AVR_IO_REGBIT(TIFR, OCF1B),
+                    .vector = TIMER1_COMPB_vect,
+                },
+            },
+        },
+    },
+    .timer3 = {
+        .name = '3',
+        .wgm = { AVR_IO_REGBIT(TCCR3A, WGM30), AVR_IO_REGBIT(TCCR3A, WGM31),
+                 AVR_IO_REGBIT(TCCR3B, WGM32), AVR_IO_REGBIT(TCCR3B, WGM33) },
+        .wgm_op = {
+            [0] = AVR_TIMER_WGM_NORMAL16(),
+            [4] = AVR_TIMER_WGM_CTC(),
+            [5] = AVR_TIMER_WGM_FASTPWM8(),
+            [6] = AVR_TIMER_WGM_FASTPWM9(),
+            [7] = AVR_TIMER_WGM_FASTPWM10(),
+            [12] = AVR_TIMER_WGM_ICCTC(), //The step timers run in this mode.
+            [14] = AVR_TIMER_WGM_ICPWM(),
+            [15] = AVR_TIMER_WGM_OCPWM(),
+        },
+        .cs = { AVR_IO_REGBIT(TCCR3B, CS30), AVR_IO_REGBIT(TCCR3B, CS31), AVR_IO_REGBIT(TCCR3B, CS32) },
+        .cs_div = { 0, 0, 3 /* 8 */, 6 /* 64 */, 8 /* 256 */, 10 /* 1024 */ },
+
+        .r_tcnt = TCNT3L,
+        .r_tcnth = TCNT3H,
+        .r_icr = ICR3L,
+        .r_icrh = ICR3H,
+
+        .overflow = {
+            .enable = AVR_IO_REGBIT(ETIMSK, TOIE3),
+            .raised = AVR_IO_REGBIT(ETIFR, TOV3),
+            .vector = TIMER3_OVF_vect,
+        },
+        .icr = {
+            .enable = AVR_IO_REGBIT(ETIMSK, TICIE3),
+            .raised = AVR_IO_REGBIT(ETIFR, ICF3),
+            .vector = TIMER3_CAPT_vect,
+        },
+        .comp = {
+            [AVR_TIMER_COMPA] = {
+                .r_ocr = OCR3AL,
+                .r_ocrh = OCR3AH,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(ETIMSK, OCIE3A),
+                    .raised = AVR_IO_REGBIT(ETIFR, OCF3A),
+                    .vector = TIMER3_COMPA_vect,
+                },
+            },
+            [AVR_TIMER_COMPB] = {
+                .r_ocr = OCR3BL,
+                .r_ocrh = OCR3BH,
+                .interrupt = {
+                    .enable = AVR_IO_REGBIT(ETIMSK, OCIE3B),
+                    .raised = AVR_IO_REGBIT(ETIFR, OCF3B),
+                    .vector = TIMER3_COMPB_vect,
+                },
+            },
+        },
+    },
+};
+
+avr_t * mega162_make(void)
+{
+    return avr_core_allocate(&mcu_mega162.core, sizeof(struct mcu_t));
+}
+
+static void init(struct avr_t * avr)
+{
+    struct mcu_t * mcu = (struct mcu_t*)avr;
+
+    avr_eeprom_init(avr, &mcu->eeprom);
+    avr_ioport_init(avr, &mcu->porta);
+    avr_ioport_init(avr, &mcu->portb);
+    avr_ioport_init(avr, &mcu->portc);
+    avr_ioport_init(avr, &mcu->portd);
+    avr_ioport_init(avr, &mcu->porte);
+    avr_uart_init(avr, &mcu->uart0);
+    avr_timer_init(avr, &mcu->timer0);
+    avr_timer_init(avr, &mcu->timer1);
+    avr_timer_init(avr, &mcu->timer3);
+}
+
+static void reset(struct avr_t * avr)
+{
+    avr->data[UCSR0C_SHADOW] = UCSR0C_RESET;
+}
@@ -0,0 +1,9 @@
+
+#ifndef __SIM_MEGA162_H__
+#define __SIM_MEGA162_H__
+
+#include "sim_avr.h"
+
+avr_t * mega162_make(void);
+
+#endif //__SIM_MEGA162_H__